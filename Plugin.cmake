@@ -20,6 +20,7 @@ set(OCPN_RELEASE_REPO
     CACHE STRING
     "Default repository for tagged builds not matching 'beta'"
 )
+option(MAYARA_BUILD_TESTS "Build the tests and benchmarks in test/, run with ctest" OFF)
 
 #
 # -------  Plugin setup --------
@@ -60,12 +61,30 @@ set(PKG_INFO_URL https://github.com/MarineYachtRadar/mayara-server)
 set(SRC
   include/mayara_server_pi.h
   include/pi_common.h
+  include/simd.h
   include/MayaraClient.h
+  include/OwnShip.h
+  include/RadarMessageReader.h
   include/SpokeReceiver.h
+  include/FrameQueue.h
+  include/FramePool.h
+  include/SpokeIngest.h
+  include/SpokeRing.h
+  include/SpokeResampler.h
+  include/SpokeDecimator.h
+  include/ScanIntegrator.h
+  include/BlobDetector.h
+  include/TargetTracker.h
+  include/TargetTable.h
+  include/TargetReceiver.h
+  include/TargetIndex.h
   include/SpokeBuffer.h
   include/ColorPalette.h
   include/icons.h
   include/gl_funcs.h
+  include/PolarLookup.h
+  include/RadarRasterizer.h
+  include/TrailBuffer.h
   include/RadarRenderer.h
   include/RadarOverlayRenderer.h
   include/RadarPPIRenderer.h
@@ -78,11 +97,28 @@ set(SRC
 
   src/mayara_server_pi.cpp
   src/MayaraClient.cpp
+  src/OwnShip.cpp
+  src/RadarMessageReader.cpp
   src/SpokeReceiver.cpp
+  src/FrameQueue.cpp
+  src/FramePool.cpp
+  src/SpokeIngest.cpp
+  src/SpokeRing.cpp
+  src/SpokeResampler.cpp
+  src/SpokeDecimator.cpp
+  src/ScanIntegrator.cpp
+  src/BlobDetector.cpp
+  src/TargetTracker.cpp
+  src/TargetTable.cpp
+  src/TargetReceiver.cpp
+  src/TargetIndex.cpp
   src/SpokeBuffer.cpp
   src/ColorPalette.cpp
   src/icons.cpp
   src/gl_funcs.cpp
+  src/PolarLookup.cpp
+  src/RadarRasterizer.cpp
+  src/TrailBuffer.cpp
   src/RadarRenderer.cpp
   src/RadarOverlayRenderer.cpp
   src/RadarPPIRenderer.cpp
@@ -132,6 +168,11 @@ macro(late_init)
     # This enables shader function declarations in glext.h
     target_compile_definitions(${PACKAGE_NAME} PRIVATE GL_GLEXT_PROTOTYPES)
   endif()
+
+  if (MAYARA_BUILD_TESTS)
+    enable_testing()
+    add_subdirectory(test)
+  endif ()
 endmacro ()
 
 macro(add_plugin_libraries)
@@ -0,0 +1,138 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * CFAR target detection on complete sweeps
+ */
+
+#ifndef _BLOB_DETECTOR_H_
+#define _BLOB_DETECTOR_H_
+
+#include "pi_common.h"
+#include "SpokeBuffer.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Echoes detected in one sweep, one entry per blob in each array, so a
+// pass over one field (e.g. position for gating) stays in cache.
+// Angles are in spokes of the sweep, clockwise from the bow; ranges are
+// in samples of the sweep's grid.
+struct BlobList {
+    uint64_t revolution = 0;     // Sweep the blobs were found in
+    uint64_t time = 0;           // Unix ms, middle of the sweep
+    size_t spokes = 0;
+    size_t spokeLen = 0;
+    uint32_t gridRange = 0;      // Meters of the last sample
+
+    std::vector<float> angle;            // Intensity weighted centroid
+    std::vector<float> range;
+    std::vector<uint32_t> angleFirst;    // Extent: first spoke clockwise,
+    std::vector<uint32_t> angleCount;    // may wrap past the bow
+    std::vector<uint16_t> rangeFirst;
+    std::vector<uint16_t> rangeCount;
+    std::vector<uint8_t> peak;           // Strongest sample
+    std::vector<uint32_t> cells;         // Samples detected
+
+    size_t size() const { return angle.size(); }
+    void clear();
+
+    // Centroid in degrees relative to the bow and in meters
+    double GetBearing(size_t i) const { return spokes ? angle[i] * 360.0 / spokes : 0.0; }
+    double GetDistance(size_t i) const { return spokeLen ? range[i] * gridRange / spokeLen : 0.0; }
+};
+
+// Cell averaging CFAR along every spoke of a sweep, followed by connected
+// component labelling of the detections.
+//
+// A sample is detected when it is above both the noise floor and 'factor'
+// times the mean of the reference window: 'window' samples on each side,
+// separated from it by 'guard' samples. Window sums come from a running
+// prefix sum, and the comparisons run 16 samples at a time.
+//
+// Detections are grouped into runs along each spoke, and runs touching
+// in range on adjacent spokes (including diagonally and across the bow)
+// are joined with union-find, so the cost follows the number of runs
+// rather than the number of samples.
+//
+// Not thread safe; one detector per radar, called from one thread.
+class BlobDetector {
+public:
+    BlobDetector();
+
+    // Reference window and guard cells on each side of the sample
+    void SetWindow(size_t window, size_t guard);
+
+    // Detection threshold relative to the local mean
+    void SetFactor(float factor) { m_factor = factor; }
+
+    // Samples below this are never detected
+    void SetNoiseFloor(uint8_t level) { m_noise_floor = level; }
+
+    // Samples closer than this are ignored (main bang, own ship)
+    void SetMinRange(size_t samples) { m_min_range = samples; }
+
+    // Blobs outside this size in samples are dropped (speckle, land)
+    void SetBlobCells(size_t min_cells, size_t max_cells);
+
+    // Detect the blobs of one sweep into 'blobs'
+    void Detect(const Sweep& sweep, BlobList& blobs);
+
+private:
+    // Mark detected samples of one spoke in m_hits (0xFF or 0)
+    void DetectRow(const uint8_t* row, size_t len);
+
+    // Append the runs of m_hits on this spoke, with their weights
+    void ExtractRuns(uint32_t angle, const uint8_t* row, size_t len);
+
+    // Join the runs [a_first, a_end) with the touching runs of
+    // [b_first, b_end); both are sorted by range
+    void JoinRuns(size_t a_first, size_t a_end, size_t b_first, size_t b_end);
+    uint32_t Find(uint32_t run);
+    void Union(uint32_t a, uint32_t b);
+
+    size_t m_window;
+    size_t m_guard;
+    float m_factor;
+    uint8_t m_noise_floor;
+    size_t m_min_range;
+    size_t m_min_cells;
+    size_t m_max_cells;
+
+    // Scratch, one spoke
+    std::vector<uint32_t> m_prefix;      // m_prefix[i] = sum of samples [0, i)
+    std::vector<uint8_t> m_hits;
+
+    // Runs of the whole sweep, in spoke order
+    std::vector<uint32_t> m_run_angle;
+    std::vector<uint16_t> m_run_start;
+    std::vector<uint16_t> m_run_end;     // Exclusive
+    std::vector<uint32_t> m_run_weight;  // Sum of samples
+    std::vector<uint64_t> m_run_moment;  // Sum of sample x range
+    std::vector<uint8_t> m_run_peak;
+    std::vector<uint32_t> m_parent;
+    std::vector<size_t> m_spoke_runs;    // First run of every spoke, + end
+
+    // Components being summed up, found through the index of their root
+    // run. Angles are relative to the first spoke seen, so a blob across
+    // the bow stays in one piece.
+    struct Component {
+        uint32_t refAngle;
+        int32_t minDelta;
+        int32_t maxDelta;
+        uint16_t rangeFirst;
+        uint16_t rangeEnd;
+        uint8_t peak;
+        uint32_t cells;
+        uint64_t weight;
+        double angleMoment;
+        uint64_t rangeMoment;
+    };
+    std::vector<Component> m_components;
+    std::vector<uint32_t> m_component_of_root;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _BLOB_DETECTOR_H_
@@ -0,0 +1,52 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Fixed set of reusable frame buffers
+ */
+
+#ifndef _FRAME_POOL_H_
+#define _FRAME_POOL_H_
+
+#include "pi_common.h"
+#include "FrameQueue.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// All frame buffers of one radar, allocated up front and recycled
+// between socket, ingest queue and decoder. Acquire() and Release() are
+// lock-free; the free list is itself a FrameQueue.
+class FramePool {
+public:
+    // frame_capacity is the initial size of each buffer. A frame larger
+    // than that grows its buffer once, which then stays that size.
+    FramePool(size_t frames, size_t frame_capacity);
+    ~FramePool();
+
+    // Take a free frame, nullptr if all are in use
+    Frame* Acquire();
+    void Release(Frame* frame);
+
+    // Copy 'len' bytes into 'frame', growing its buffer if needed
+    void Fill(Frame* frame, const uint8_t* data, size_t len);
+
+    size_t GetFrameCount() const { return m_frames.size(); }
+
+    // Buffers grown for oversized frames, each one an allocation
+    uint64_t GetGrown() const { return m_grown.load(std::memory_order_relaxed); }
+
+    // Bytes a RadarMessage frame needs for 'spokes' spokes of up to
+    // 'max_spoke_len' samples
+    static size_t FrameCapacity(size_t spokes, size_t max_spoke_len);
+
+private:
+    std::vector<Frame> m_frames;
+    FrameQueue m_free;
+    std::atomic<uint64_t> m_grown;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _FRAME_POOL_H_
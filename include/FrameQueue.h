@@ -0,0 +1,69 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Bounded lock-free queue of raw WebSocket frames
+ */
+
+#ifndef _FRAME_QUEUE_H_
+#define _FRAME_QUEUE_H_
+
+#include "pi_common.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// One raw RadarMessage. Frames come from a FramePool and are passed
+// around by pointer, the bytes are never copied after the socket.
+struct Frame {
+    std::vector<uint8_t> data;   // Capacity, only grows for oversized frames
+    size_t length;               // Valid bytes in data
+};
+
+// Fixed-capacity multi-producer/multi-consumer queue of frame pointers
+// (Vyukov's bounded array queue). Never allocates after construction.
+class FrameQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit FrameQueue(size_t capacity);
+    ~FrameQueue();
+
+    // Queue 'frame'. Returns false if the queue is full.
+    bool TryPush(Frame* frame);
+
+    // Queue 'frame', dropping the oldest queued frame if full: for a live
+    // radar the newest data is always the most useful. Returns the
+    // dropped frame, which the caller must release, or nullptr.
+    Frame* Push(Frame* frame);
+
+    // Take the oldest frame, nullptr if the queue is empty
+    Frame* Pop();
+
+    bool IsEmpty() const;
+    size_t GetCapacity() const { return m_mask + 1; }
+
+    // Frames accepted by Push() and frames it had to drop to make room
+    uint64_t GetQueued() const { return m_queued.load(std::memory_order_relaxed); }
+    uint64_t GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Frame* frame;
+    };
+
+    size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+    alignas(64) std::atomic<size_t> m_dequeue_pos;
+    alignas(64) std::atomic<uint64_t> m_queued;
+    std::atomic<uint64_t> m_dropped;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _FRAME_QUEUE_H_
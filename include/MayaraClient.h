@@ -27,6 +27,7 @@ struct RadarInfo {
     RadarStatus status;
     int spokesPerRevolution;
     int maxSpokeLength;
+    int pixelValues;         // Distinct intensity levels, 0 if unknown
     double rangeMeters;
 };
 
@@ -109,6 +110,7 @@ struct Characteristics {
     std::vector<uint32_t> supportedRanges;
     uint16_t spokesPerRevolution;
     uint16_t maxSpokeLength;
+    uint16_t pixelValues;       // Distinct spoke intensity levels, 0 if not sent
     bool hasDoppler;
     bool hasDualRange;
     uint32_t maxDualRange;
@@ -145,6 +147,7 @@ struct CapabilityManifest {
     // Legacy compatibility
     int spokesPerRevolution() const { return characteristics.spokesPerRevolution; }
     int maxSpokeLength() const { return characteristics.maxSpokeLength; }
+    int pixelValues() const { return characteristics.pixelValues; }
 };
 
 // Control value - supports all control types
@@ -214,10 +217,10 @@ struct RadarState {
 // ARPA target
 struct ArpaTarget {
     int targetId;
-    double bearing;      // degrees
+    double bearing;      // degrees true
     double distance;     // meters
     double speed;        // knots
-    double course;       // degrees
+    double course;       // degrees true
     double cpa;          // closest point of approach (meters)
     double tcpa;         // time to CPA (minutes)
 };
@@ -0,0 +1,68 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Own ship motion between position fixes
+ */
+
+#ifndef _OWN_SHIP_H_
+#define _OWN_SHIP_H_
+
+#include "pi_common.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Latest position fix, heading, COG and SOG of own ship, as used by the
+// trails and the local tracker. Positions are in meters east and north
+// of an anchor on a flat earth, which stays accurate within tens of
+// kilometers of the anchor. Between fixes the position is dead reckoned
+// from COG and SOG for up to a minute.
+//
+// Not thread safe; it is a plain value that owners copy under their lock.
+class OwnShip {
+public:
+    static constexpr double KNOTS_TO_MPS = 1852.0 / 3600.0;
+
+    // Users move their anchor closer to own ship once it is this far
+    // away, keeping the flat earth approximation accurate
+    static constexpr double REANCHOR_METERS = 50000.0;
+
+    OwnShip();
+
+    // Heading in degrees true (NaN falls back to COG), COG in degrees and
+    // SOG in knots; now_ms is the local time in ms
+    void Set(const GeoPosition& position, double heading, double cog, double sog,
+             int64_t now_ms);
+
+    bool HasFix() const { return m_fix_time != 0; }
+    const GeoPosition& GetFix() const { return m_fix; }
+
+    // Degrees true, COG without a heading and 0 without either
+    double GetHeading() const;
+
+    // Velocity over ground in m/s, zero without COG and SOG
+    void GetVelocity(double& east, double& north) const;
+
+    // Dead reckoned position at local time now_ms
+    void GetPosition(const GeoPosition& anchor, int64_t now_ms,
+                     double& east, double& north) const;
+
+    // Meters from anchor to position
+    static void Offset(const GeoPosition& anchor, const GeoPosition& position,
+                       double& east, double& north);
+
+    // Position at meters from anchor, the inverse of Offset()
+    static GeoPosition Move(const GeoPosition& anchor, double east, double north);
+
+private:
+    GeoPosition m_fix;
+    double m_hdt;
+    double m_cog;
+    double m_sog;
+    int64_t m_fix_time;                 // Local ms of the last new fix
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _OWN_SHIP_H_
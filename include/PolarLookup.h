@@ -0,0 +1,54 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Precomputed cartesian to polar coordinate table for the radar disk
+ */
+
+#ifndef _POLAR_LOOKUP_H_
+#define _POLAR_LOOKUP_H_
+
+#include "pi_common.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Square table covering the unit quad [-1, 1] x [-1, 1] with the bow at
+// -y, row 0 at the bow edge. Each texel holds two 16-bit fixed point
+// fractions:
+//   range  0..65534 maps to 0..1 of the radar range, OUTSIDE if beyond it
+//   angle  0..65535 maps to 0..1 of a revolution, clockwise from the bow
+//          (65535 wraps to the bow again)
+// The table is normalized, so it only depends on its size, not on the
+// spoke count or spoke length.
+class PolarLookup {
+public:
+    static const uint16_t OUTSIDE = 0xFFFF;
+
+    PolarLookup();
+
+    // Rebuild for a size x size table. Returns false if it already had
+    // that size and nothing changed.
+    bool Build(size_t size);
+
+    // Free the table once it has been consumed; the next Build() rebuilds
+    // it whatever its size
+    void Release();
+
+    size_t GetSize() const { return m_size; }
+
+    // Interleaved (range, angle) pairs, size * size * 2 values
+    const uint16_t* GetTable() const { return m_table.data(); }
+
+    uint16_t GetRange(size_t x, size_t y) const { return m_table[(y * m_size + x) * 2]; }
+    uint16_t GetAngle(size_t x, size_t y) const { return m_table[(y * m_size + x) * 2 + 1]; }
+
+private:
+    size_t m_size;
+    std::vector<uint16_t> m_table;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _POLAR_LOOKUP_H_
@@ -34,6 +34,7 @@ private:
     void OnOK(wxCommandEvent& event);
     void OnCancel(wxCommandEvent& event);
     void OnTestConnection(wxCommandEvent& event);
+    void OnIntegrationRevolutions(wxSpinEvent& event);
 
     void CreateControls();
     void LoadSettings();
@@ -52,6 +53,21 @@ private:
     // Display options
     wxCheckBox* m_overlay_checkbox;
     wxCheckBox* m_ppi_checkbox;
+    wxCheckBox* m_detection_checkbox;
+    wxCheckBox* m_auto_acquire_checkbox;
+    wxSpinCtrlDouble* m_detection_threshold_ctrl;
+
+    // Performance
+    wxChoice* m_decimation_choice;
+    wxChoice* m_decimation_mode_choice;
+    wxChoice* m_integration_choice;
+    wxSpinCtrl* m_integration_revolutions_ctrl;
+    wxSpinCtrl* m_integration_required_ctrl;
+    wxSpinCtrlDouble* m_afterglow_ctrl;
+
+    // Trails
+    wxChoice* m_trail_mode_choice;
+    wxChoice* m_trail_length_choice;
 
     // Status
     wxStaticText* m_status_text;
@@ -37,11 +37,14 @@ private:
     void OnSize(wxSizeEvent& event);
     void OnMouseWheel(wxMouseEvent& event);
     void OnLeftDown(wxMouseEvent& event);
+    void OnLeftUp(wxMouseEvent& event);
+    void OnMotion(wxMouseEvent& event);
     void OnRightDown(wxMouseEvent& event);
     void OnKeyDown(wxKeyEvent& event);
     void OnClose(wxCloseEvent& event);
 
-    // Convert mouse position to radar coordinates (bearing, distance)
+    // Convert mouse position to radar coordinates: bearing relative to
+    // the bow (degrees) and distance (meters)
     bool MouseToRadar(int x, int y, double& bearing, double& distance);
 
     ::mayara_server_pi* m_plugin;
@@ -51,11 +54,19 @@ private:
     // Zoom level (1.0 = fit to window)
     double m_zoom;
 
+    // Pan offset of the radar center in pixels
+    float m_pan_x;
+    float m_pan_y;
+
     // Drag state
     bool m_dragging;
+    bool m_drag_moved;
     int m_drag_start_x;
     int m_drag_start_y;
 
+    // Target selected by clicking it, -1 for none
+    int m_selected_target;
+
     DECLARE_EVENT_TABLE()
 };
 
@@ -12,7 +12,14 @@
 #include "pi_common.h"
 #include "MayaraClient.h"
 #include "SpokeReceiver.h"
+#include "TargetReceiver.h"
+#include "SpokeIngest.h"
 #include "SpokeBuffer.h"
+#include "SpokeDecimator.h"
+#include "ScanIntegrator.h"
+#include "TrailBuffer.h"
+#include "BlobDetector.h"
+#include "TargetTracker.h"
 #include <memory>
 
 // Forward declaration - plugin class is in global namespace
@@ -47,6 +54,10 @@ public:
     std::string GetModel() const { return m_info.model; }
     RadarStatus GetStatus() const { return m_status; }
     double GetRangeMeters() const { return m_range_meters; }
+
+    // Range covered by the radar image, which follows the spokes rather
+    // than the range control. Render thread only.
+    double GetImageRangeMeters() const;
     int GetSpokesPerRevolution() const { return m_spokes_per_revolution; }
     int GetMaxSpokeLength() const { return m_max_spoke_length; }
 
@@ -57,19 +68,33 @@ public:
     RadarOverlayRenderer* GetOverlayRenderer() { return m_overlay_renderer.get(); }
     RadarPPIRenderer* GetPPIRenderer() { return m_ppi_renderer.get(); }
 
+    // Ingest worker, for frame statistics
+    SpokeIngest* GetIngest() { return m_ingest.get(); }
+
     // Get spoke buffer (for renderers)
     SpokeBuffer* GetSpokeBuffer() { return m_spoke_buffer.get(); }
 
+    // Trail history, updated and drawn on the render thread
+    TrailBuffer* GetTrailBuffer() { return m_trail_buffer.get(); }
+
+    // Echoes detected in the last complete revolution, nullptr until the
+    // first one or when local detection is off. Any thread.
+    std::shared_ptr<const BlobList> GetBlobs() const { return std::atomic_load(&m_blobs); }
+
     // Get/set PPI window
     RadarCanvas* GetPPIWindow() { return m_ppi_window; }
     void SetPPIWindow(RadarCanvas* window) { m_ppi_window = window; }
 
-    // ARPA targets
-    std::vector<ArpaTarget> GetTargets() const { return m_targets; }
+    // Local tracker, nullptr unless detecting locally
+    TargetTracker* GetTracker() { return m_tracker.get(); }
+
+    // ARPA targets: from the local tracker when there is one, otherwise
+    // as streamed from the server. Immutable, any thread.
+    std::shared_ptr<const std::vector<ArpaTarget>> GetTargets() const;
     void UpdateTargets(const std::vector<ArpaTarget>& targets);
 
 private:
-    void OnSpokeReceived(const SpokeData& spoke);
+    void OnSpokeBatch(const SpokeData* spokes, size_t count);
 
     ::mayara_server_pi* m_plugin;
     std::string m_id;
@@ -83,15 +108,26 @@ private:
 
     // Components
     std::unique_ptr<SpokeReceiver> m_receiver;
+    std::unique_ptr<TargetReceiver> m_target_receiver;
+    std::unique_ptr<SpokeIngest> m_ingest;
     std::unique_ptr<SpokeBuffer> m_spoke_buffer;
+    std::unique_ptr<SpokeDecimator> m_decimator;  // Only when decimating
+    std::vector<SpokeData> m_decimated;           // Ingest thread scratch
+    std::unique_ptr<ScanIntegrator> m_integrator; // Only when filtering
+    std::vector<SpokeData> m_integrated;          // Ingest thread scratch
+    std::unique_ptr<TrailBuffer> m_trail_buffer;
+    std::unique_ptr<BlobDetector> m_detector;     // Only when detecting locally
+    uint64_t m_detected_revolutions;              // Ingest thread
+    std::shared_ptr<const BlobList> m_blobs;
+    std::unique_ptr<TargetTracker> m_tracker;     // Runs with the detector
     std::unique_ptr<RadarOverlayRenderer> m_overlay_renderer;
     std::unique_ptr<RadarPPIRenderer> m_ppi_renderer;
 
     // Optional PPI window (owned by wxWidgets, not us)
     RadarCanvas* m_ppi_window;
 
-    // ARPA targets
-    std::vector<ArpaTarget> m_targets;
+    // ARPA targets from the server
+    TargetTable m_target_table;
 
     wxCriticalSection m_lock;
 };
@@ -0,0 +1,61 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Allocation-free decoder for the RadarMessage protobuf (proto/RadarMessage.proto)
+ */
+
+#ifndef _RADAR_MESSAGE_READER_H_
+#define _RADAR_MESSAGE_READER_H_
+
+#include "pi_common.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+// One spoke decoded from a RadarMessage.
+// 'data' points into the received frame and is only valid while that
+// frame is alive, i.e. for the duration of the spoke callback.
+struct SpokeData {
+    uint32_t angle;          // 0 to spokesPerRevolution-1
+    uint32_t bearing;        // Optional true bearing
+    bool hasBearing;
+    uint32_t rangeMeters;    // Range of last pixel
+    uint64_t timestamp;      // Unix timestamp in ms (0 if not sent)
+    int64_t lat;             // 1e-16 degrees (0 if not sent)
+    int64_t lon;             // 1e-16 degrees (0 if not sent)
+    const uint8_t* data;     // Pixel intensities
+    size_t length;
+};
+
+// Walks the protobuf wire format of a RadarMessage in place.
+// Usage:
+//     RadarMessageReader reader(frame, frame_len);
+//     SpokeData spoke;
+//     while (reader.Next(spoke)) { ... }
+//     if (reader.HasError()) { ... }
+class RadarMessageReader {
+public:
+    RadarMessageReader(const uint8_t* data, size_t len);
+
+    // Decode the next spoke. Returns false at end of message or on
+    // malformed input (check HasError() to tell them apart).
+    bool Next(SpokeData& spoke);
+
+    bool HasError() const { return m_error; }
+
+    // RadarMessage.radar, valid once the field has been passed
+    uint32_t GetRadar() const { return m_radar; }
+
+private:
+    bool DecodeSpoke(const uint8_t* p, const uint8_t* end, SpokeData& spoke);
+
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+    uint32_t m_radar;
+    bool m_error;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _RADAR_MESSAGE_READER_H_
@@ -19,7 +19,7 @@ public:
     ~RadarOverlayRenderer() override;
 
     // Initialize with radar parameters
-    bool Init(size_t spokes, size_t maxSpokeLen) override;
+    bool Init(size_t spokes, size_t maxSpokeLen, bool packed = false) override;
 
     // Render radar overlay on chart
     void DrawOverlay(wxGLContext* context,
@@ -28,17 +28,50 @@ public:
                      const GeoPosition& radar_pos,
                      double heading);
 
+    // Render on a non-GL chart canvas through the CPU rasterizer. Needs no
+    // GL context or Init(), and drains the spoke buffer itself.
+    void DrawOverlayDC(wxDC& dc,
+                       PlugIn_ViewPort* vp,
+                       double range_meters,
+                       const GeoPosition& radar_pos,
+                       double heading,
+                       SpokeBuffer* buffer);
+
+protected:
+    bool CompileShaders() override;
+
 private:
     // Shader sources for overlay rendering
     static const char* GetVertexShaderSource();
     static const char* GetFragmentShaderSource();
 
-    // Shader uniform locations
+    // Radar center and radius in canvas pixels, clockwise rotation of the bow
+    void GetScreenGeometry(PlugIn_ViewPort* vp, double range_meters,
+                           const GeoPosition& radar_pos, double heading,
+                           float& cx, float& cy, float& radius, float& rotation);
+
+    // Draw paths
+    void DrawPolarQuad(float cx, float cy, float radius, float rotation);
+
+    // Shader attribute/uniform locations
+    GLint m_loc_position;
     GLint m_loc_center;
     GLint m_loc_scale;
     GLint m_loc_rotation;
     GLint m_loc_texture;
     GLint m_loc_palette;
+
+    // Last frame of the non-GL path: the visible part of the disk, at
+    // window position (m_dc_x, m_dc_y), and the rasterizer column and row
+    // each of its pixels shows
+    wxImage m_dc_image;
+    wxBitmap m_dc_bitmap;
+    int m_dc_x;
+    int m_dc_y;
+    std::vector<uint32_t> m_dc_shown_x;
+    std::vector<uint32_t> m_dc_shown_y;
+    std::vector<uint32_t> m_dc_map_x;     // Scratch for the current frame
+    std::vector<uint32_t> m_dc_map_y;
 };
 
 PLUGIN_END_NAMESPACE
@@ -11,6 +11,7 @@
 
 #include "RadarRenderer.h"
 #include "MayaraClient.h"
+#include "TargetIndex.h"
 #include <vector>
 
 PLUGIN_BEGIN_NAMESPACE
@@ -21,7 +22,10 @@ public:
     ~RadarPPIRenderer() override;
 
     // Initialize with radar parameters
-    bool Init(size_t spokes, size_t maxSpokeLen) override;
+    bool Init(size_t spokes, size_t maxSpokeLen, bool packed = false) override;
+
+    // Also releases the target program and vertex buffer
+    void Reset() override;
 
     // Render PPI display
     void DrawPPI(wxGLContext* context,
@@ -29,38 +33,115 @@ public:
                  double range_meters,
                  double heading);
 
-    // Draw overlay elements
+    // Draw overlay elements. Targets are batched: all symbols are one
+    // draw call and all vectors and labels another, with each symbol
+    // turned to its course in the vertex shader. Target bearings and
+    // courses are true, and drawn over their echoes for the same heading
+    // as DrawPPI().
     void DrawRangeRings(int width, int height, double range_meters, int num_rings = 4);
     void DrawHeadingLine(int width, int height, double heading);
-    void DrawTargets(int width, int height, double range_meters,
+    void DrawTargets(int width, int height, double range_meters, double heading,
                      const std::vector<ArpaTarget>& targets);
 
+    // Id of the target drawn nearest to a window position, within
+    // max_distance pixels, or -1. Uses the positions of the last
+    // DrawTargets().
+    int HitTestTarget(float x, float y, float max_distance) const;
+
+    // Target drawn highlighted and labelled first, -1 for none
+    void SetSelectedTarget(int target_id) { m_selected_target = target_id; }
+
+    // View transform: zoom (1.0 = fit to window) and pan in pixels
+    void SetView(double zoom, float pan_x, float pan_y);
+
+    // Screen center and radius of the radar disk for the current view
+    void GetDisplayGeometry(int width, int height,
+                            float& cx, float& cy, float& radius) const;
+
     // Settings
     void SetShowRangeRings(bool show) { m_show_range_rings = show; }
     void SetShowHeadingLine(bool show) { m_show_heading_line = show; }
     void SetShowTargets(bool show) { m_show_targets = show; }
 
+protected:
+    bool CompileShaders() override;
+
 private:
     // Shader sources for PPI rendering
     static const char* GetVertexShaderSource();
     static const char* GetFragmentShaderSource();
+    static const char* GetTargetVertexShaderSource();
+    static const char* GetTargetFragmentShaderSource();
+
+    // One vertex of the batched target geometry: the target position in
+    // window pixels, the offset of the vertex from it before turning by
+    // course (radians, clockwise from screen-up) and its color
+    struct TargetVertex {
+        float x, y;
+        float offset_x, offset_y;
+        float course;
+        uint8_t color[4];
+    };
+
+    bool CompileTargetShaders();
+    void DeleteTargetResources();
+    static void AddTargetVertex(std::vector<TargetVertex>& vertices,
+                                float x, float y, float offset_x, float offset_y,
+                                float course, const uint8_t* color);
+    void AddNumber(float x, float y, int number, const uint8_t* color);
+
+    // One draw call for the whole batch, from the stream buffer when there
+    // is one, turning on the CPU when there are no shaders
+    void DrawTargetVertices(const std::vector<TargetVertex>& vertices, GLenum mode);
 
     // Drawing helpers
     void DrawCircle(float cx, float cy, float radius, int segments = 64);
     void DrawLine(float x1, float y1, float x2, float y2);
-    void DrawTriangle(float x, float y, float size, float rotation);
 
-    // Shader uniform locations
+    // Shader attribute/uniform locations
+    GLint m_loc_position;
     GLint m_loc_center;
     GLint m_loc_radius;
     GLint m_loc_rotation;
     GLint m_loc_texture;
     GLint m_loc_palette;
 
+    // Target program and its stream vertex buffer
+    GLuint m_target_program;
+    GLuint m_target_vertex_shader;
+    GLuint m_target_fragment_shader;
+    GLuint m_target_vbo;
+    GLint m_target_loc_position;
+    GLint m_target_loc_offset;
+    GLint m_target_loc_course;
+    GLint m_target_loc_color;
+
+    // View transform
+    double m_zoom;
+    float m_pan_x;
+    float m_pan_y;
+
     // Display options
     bool m_show_range_rings;
     bool m_show_heading_line;
     bool m_show_targets;
+
+    // Targets as last drawn, in window pixels, and their labels
+    TargetIndex m_target_index;
+    std::vector<float> m_target_x;
+    std::vector<float> m_target_y;
+    std::vector<int> m_target_ids;
+    std::vector<float> m_target_distance;
+    std::vector<uint32_t> m_label_order;
+    std::vector<float> m_label_left;
+    std::vector<float> m_label_top;
+    std::vector<uint8_t> m_label_shown;
+    int m_selected_target;
+
+    // Target geometry, rebuilt every frame
+    std::vector<TargetVertex> m_symbol_vertices;     // GL_TRIANGLES
+    std::vector<TargetVertex> m_line_vertices;       // GL_LINES
+    std::vector<float> m_turned_vertices;            // Without shaders
 };
 
 PLUGIN_END_NAMESPACE
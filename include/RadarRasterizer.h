@@ -0,0 +1,115 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * CPU scan converter from polar spokes to an RGBA bitmap
+ */
+
+#ifndef _RADAR_RASTERIZER_H_
+#define _RADAR_RASTERIZER_H_
+
+#include "pi_common.h"
+#include "ColorPalette.h"
+#include "PolarLookup.h"
+#include "SpokeBuffer.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Software counterpart of the polar shaders, used when GL shaders are
+// unavailable, for the non-GL chart overlay and for headless testing.
+//
+// Every pixel of the disk is assigned to the spoke it shows, and pixels
+// are stored grouped by spoke, so a new spoke only touches its own
+// pixels. Pixels outside the disk stay transparent.
+//
+// Touches no GL or wx state; call Update() on the thread that drains the
+// SpokeBuffer, after Drain().
+class RadarRasterizer {
+public:
+    RadarRasterizer();
+    ~RadarRasterizer();
+
+    // Output is a size x size bitmap covering the radar disk, bow up
+    void SetSize(size_t size);
+    size_t GetSize() const { return m_size; }
+
+    // Rotate the image clockwise (radians). Rotation is quantized to whole
+    // spokes, so it only re-indexes spokes and never rebuilds the tables.
+    void SetRotation(double rotation);
+
+    void SetColorPalette(const ColorPalette& palette);
+
+    // Re-rasterize the pixels of the sector swept since the last call, or
+    // everything after a size, rotation, palette or geometry change.
+    // Returns true if the bitmap changed.
+    bool Update(SpokeBuffer* buffer);
+
+    // Force a full re-rasterization on the next Update()
+    void Invalidate() { m_full = true; }
+
+    // RGBA bytes, row major, row 0 at the top
+    const uint8_t* GetPixels() const { return (const uint8_t*)m_pixels.data(); }
+
+    // Pixels written by the last Update(), to verify incremental updates
+    size_t GetLastPixelCount() const { return m_last_pixel_count; }
+
+    // Bitmap rows touched by the last Update() (count 0 if none)
+    void GetDirtyRows(size_t& first, size_t& count) const {
+        first = m_dirty_row_first;
+        count = m_dirty_row_end > m_dirty_row_first ? m_dirty_row_end - m_dirty_row_first : 0;
+    }
+
+private:
+    void BuildTables(size_t spokes, size_t spoke_len);
+    size_t RasterizeSpoke(const uint8_t* row, uint32_t bucket);
+    size_t RasterizeAll(const uint8_t* data, size_t data_size);
+    size_t RasterizeAllAVX2(const uint8_t* data);     // x86 with AVX2 only
+
+    size_t m_size;
+    size_t m_spokes;
+    size_t m_spoke_len;
+    size_t m_table_size;
+
+    // SpokeBuffer row layout: sample r is bits [(r & m_pack_shift) * 4, +8)
+    // of byte r >> m_pack_shift, masked with m_sample_mask
+    size_t m_row_bytes;
+    uint32_t m_pack_shift;                // 1 if packed, else 0
+    uint32_t m_sample_mask;
+
+    double m_rotation;
+    uint32_t m_shift;                     // Rotation in spokes
+    uint32_t m_applied_shift;
+
+    PolarLookup m_lookup;                 // Released once the tables are built
+
+    // Pixels grouped by screen angle bucket, for incremental updates:
+    // bucket b owns entries [m_bucket_start[b], m_bucket_start[b + 1])
+    std::vector<uint32_t> m_bucket_start;
+    std::vector<uint32_t> m_pixel_range;  // Sample index within the spoke
+    std::vector<uint32_t> m_pixel_index;  // Index into m_pixels
+    std::vector<uint16_t> m_bucket_row_min;  // Rows each bucket's pixels span
+    std::vector<uint16_t> m_bucket_row_max;
+
+    // The same pixels in row order, for full redraws with contiguous
+    // stores: row y covers x in [m_span_x[y], m_span_x[y] + m_span_len[y])
+    std::vector<uint32_t> m_span_x;
+    std::vector<uint32_t> m_span_len;
+    std::vector<int32_t> m_span_bucket;
+    std::vector<int32_t> m_span_range;
+
+    std::vector<uint32_t> m_pixels;
+    uint32_t m_lut[256];
+
+    uint64_t m_sequence;
+    bool m_full;
+    std::vector<DirtyRun> m_dirty_runs;
+    size_t m_last_pixel_count;
+    size_t m_dirty_row_first;
+    size_t m_dirty_row_end;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _RADAR_RASTERIZER_H_
@@ -12,37 +12,121 @@
 #include "pi_common.h"
 #include "ColorPalette.h"
 #include "gl_funcs.h"
+#include "SpokeBuffer.h"
+#include "PolarLookup.h"
+#include "RadarRasterizer.h"
+#include "TrailBuffer.h"
+#include <string>
+#include <vector>
 
 PLUGIN_BEGIN_NAMESPACE
 
-// Forward declarations
-class SpokeBuffer;
-
 class RadarRenderer {
 public:
     RadarRenderer();
     virtual ~RadarRenderer();
 
-    // Initialize with radar parameters
-    virtual bool Init(size_t spokes, size_t maxSpokeLen);
+    // Initialize with radar parameters, matching the SpokeBuffer layout
+    // (packed = two 4-bit samples per byte)
+    virtual bool Init(size_t spokes, size_t maxSpokeLen, bool packed = false);
 
     // Reset/clear the renderer
     virtual void Reset();
 
-    // Update texture from spoke buffer
+    // Update texture from spoke buffer, uploading only the sector swept
+    // since the last update
     virtual void UpdateTexture(SpokeBuffer* buffer);
 
+    // Stream uploads through pixel buffer objects when the driver supports
+    // them (GL 2.1 or ARB_pixel_buffer_object), otherwise upload from
+    // client memory
+    void SetUsePBO(bool use) { m_use_pbo = use; }
+    bool IsUsingPBO() const { return m_use_pbo && m_pbo_supported; }
+
+    // Resolve angle and range per pixel from a precomputed lookup texture
+    // instead of atan/length in the fragment shader. Cheaper on weak GPUs
+    // and software GL; falls back to the analytic shader when unsupported.
+    void SetUsePolarLookup(bool use) { m_use_lookup = use; }
+    bool IsUsingPolarLookup() const { return m_use_lookup && m_lookup_program != 0; }
+
+    // Afterglow: fade echoes by age as exp(-age / time_constant), with the
+    // time constant in seconds, 0 = off. The age of every spoke is uploaded
+    // once per frame, one float per angle, and the fade is applied in the
+    // fragment shader. The CPU rasterizer path does not fade.
+    void SetAfterglow(double time_constant) { m_afterglow = time_constant; }
+    double GetAfterglow() const { return m_afterglow; }
+
+    // Copy the trail rows changed since the last call into the trail
+    // texture. Trails are drawn under the echoes while the buffer's mode
+    // is not Off, fading out over the trail length in seconds. Needs
+    // shaders; the CPU rasterizer path draws no trails.
+    void UpdateTrails(TrailBuffer* trails);
+    void SetTrailLength(double seconds) { m_trail_length = seconds; }
+
+    // Upload statistics, to verify partial uploads
+    size_t GetLastUploadBytes() const { return m_last_upload_bytes; }
+    uint64_t GetTotalUploadBytes() const { return m_total_upload_bytes; }
+
     // Set color palette
     void SetColorPalette(const ColorPalette& palette);
 
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
+    // True once the polar shader program is compiled and linked
+    bool HasShaders() const { return m_program != 0; }
+
 protected:
     // Shader compilation helpers
-    bool CompileShaders();
+    virtual bool CompileShaders();
     GLuint CompileShader(GLenum type, const char* source);
+
+    // Fragment shaders reading the radar texture are compiled behind a
+    // prelude that provides '#version 120', the radar_texture sampler,
+    // float SampleSpoke(vec2 pos), the 0..1 intensity at (range, angle),
+    // so the same source works for plain and packed textures, and
+    // float SpokeAfterglow(float angle), the 0..1 fade for the spoke age
+    GLuint CompileFragmentShader(const char* source);
+
+    // Links m_program and looks up its afterglow uniforms
     bool LinkProgram();
+    GLuint LinkProgram(GLuint vertex_shader, GLuint fragment_shader);
+
+    // Shared draw helpers for the polar shaders: bind the radar texture to
+    // unit 0 and the palette to unit 1, and draw the [-1, 1] unit quad
+    void BindRadarTextures();
+    void DrawUnitQuad(GLint loc_position);
+
+    // Bind the age texture to unit 3 and set the SpokeAfterglow() uniforms
+    // of the program in use
+    void SetAfterglowUniforms(GLint loc_age_texture, GLint loc_afterglow);
+
+    // Lookup texture path. DrawLookupQuad() draws the radar disk centered
+    // at (cx, cy) in pixels, returning false if the disk is larger than
+    // the biggest lookup table so the caller uses the analytic shader.
+    bool CompileLookupShaders();
+    bool UpdateLookupTexture(size_t size);
+    bool DrawLookupQuad(float cx, float cy, float radius, float rotation);
+
+    // Trail program. DrawTrails() takes the geometry of the radar image
+    // and turns it north up with the heading the trails were built with.
+    bool CompileTrailShaders();
+    void DrawTrails(float cx, float cy, float radius, float rotation);
+
+    // Software path for GL without shaders: the image is scan converted on
+    // the CPU in UpdateTexture() and drawn as a plain textured quad
+    bool UseRasterizer() const { return !HasShaders() && !IsUsingPolarLookup(); }
+    void UpdateRasterTexture(SpokeBuffer* buffer);
+
+    // Recompute the age of every spoke and upload it, when afterglow is on
+    void UpdateAgeTexture(SpokeBuffer* buffer);
+    void DrawRasterQuad(float cx, float cy, float radius, float rotation);
+
+    // Texture upload paths
+    void UploadRuns(SpokeBuffer* buffer);
+    bool UploadRunsPBO(SpokeBuffer* buffer);
+    void CreatePBOs(size_t size);
+    void DeletePBOs();
 
     // OpenGL resources
     GLuint m_program;
@@ -50,10 +134,72 @@ protected:
     GLuint m_fragment_shader;
     GLuint m_texture;
     GLuint m_palette_texture;
+    GLuint m_quad_vbo;
+    GLint m_loc_age_texture;
+    GLint m_loc_afterglow;
+
+    // Polar lookup program and texture (unit 2)
+    GLuint m_lookup_program;
+    GLuint m_lookup_vertex_shader;
+    GLuint m_lookup_fragment_shader;
+    GLuint m_lookup_texture;
+    size_t m_lookup_texture_size;
+    size_t m_lookup_max_size;
+    PolarLookup m_lookup;                // Released once uploaded
+    bool m_use_lookup;
+    GLint m_lookup_loc_position;
+    GLint m_lookup_loc_center;
+    GLint m_lookup_loc_scale;
+    GLint m_lookup_loc_rotation;
+    GLint m_lookup_loc_texture;
+    GLint m_lookup_loc_palette;
+    GLint m_lookup_loc_lookup;
+    GLint m_lookup_loc_age_texture;
+    GLint m_lookup_loc_afterglow;
+
+    // Trail program and texture (unit 4): stamps as two bytes per cell,
+    // low byte in luminance and high byte in alpha
+    GLuint m_trail_program;
+    GLuint m_trail_vertex_shader;
+    GLuint m_trail_fragment_shader;
+    GLuint m_trail_texture;
+    size_t m_trail_texture_size;
+    uint32_t m_trail_generation;         // TrailBuffer rows in the texture
+    bool m_trails_visible;
+    double m_trail_length;
+    float m_trail_origin_x;              // Own ship in texture coordinates
+    float m_trail_origin_y;
+    float m_trail_now;
+    float m_trail_heading;               // Degrees
+    GLint m_trail_loc_position;
+    GLint m_trail_loc_center;
+    GLint m_trail_loc_scale;
+    GLint m_trail_loc_rotation;
+    GLint m_trail_loc_texture;
+    GLint m_trail_loc_origin;
+    GLint m_trail_loc_now;
+    GLint m_trail_loc_length;
+
+    // CPU rasterizer and its RGBA texture
+    RadarRasterizer m_rasterizer;
+    GLuint m_raster_texture;
+    size_t m_raster_texture_size;
+
+    // Afterglow: spoke ages as a fraction of AFTERGLOW_SPAN time constants,
+    // one per angle (1D texture on unit 3)
+    static constexpr float AFTERGLOW_SPAN = 8.0f;
+    double m_afterglow;
+    GLuint m_age_texture;
+    std::vector<float> m_ages;
+    uint64_t m_newest_spoke_time;    // Unix ms, server clock
+    int64_t m_newest_spoke_seen;     // Local ms when it was first drawn
 
     // Radar parameters
     size_t m_spokes;
     size_t m_spoke_len_max;
+    bool m_packed;
+    size_t m_row_bytes;              // Texture width
+    std::string m_sample_source;     // Fragment shader prelude
 
     // Color palette
     ColorPalette m_palette;
@@ -61,6 +207,21 @@ protected:
     bool m_initialized;
     bool m_texture_dirty;
 
+    // Partial upload state
+    uint64_t m_uploaded_sequence;         // SpokeBuffer sequence in the texture
+    std::vector<DirtyRun> m_dirty_runs;
+    size_t m_last_upload_bytes;
+    uint64_t m_total_upload_bytes;
+
+    // Pixel buffer objects, used round-robin so the one being filled is
+    // never the one the GPU is still reading from
+    static const int PBO_COUNT = 3;
+    GLuint m_pbo[PBO_COUNT];
+    int m_pbo_index;
+    size_t m_pbo_size;
+    bool m_pbo_supported;
+    bool m_use_pbo;
+
     wxCriticalSection m_lock;
 };
 
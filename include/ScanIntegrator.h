@@ -0,0 +1,78 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Scan-to-scan correlation over the last revolutions of each spoke
+ */
+
+#ifndef _SCAN_INTEGRATOR_H_
+#define _SCAN_INTEGRATOR_H_
+
+#include "pi_common.h"
+#include "RadarMessageReader.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// How the revolutions of one angle are combined
+enum class IntegrationMode {
+    Min,        // Weakest echo: only what is there every revolution
+    Mean,       // Average, smooths fluctuating clutter
+    MofN        // Current echo where at least M of the N revolutions hit
+};
+
+// Runs on the ingest thread after the SpokeDecimator and before the
+// SpokeBuffer. Keeps the last N revolutions of every angle and replaces
+// each spoke by a combination of it and the same angle in the previous
+// revolutions. Targets persist from scan to scan while sea and rain
+// clutter decorrelate, so clutter is suppressed and targets are not.
+//
+// History restarts for an angle whose range changes, and until N
+// revolutions are in only those received are combined; MofN passes the
+// spoke through unfiltered until M revolutions are in. Memory is
+// spokes x max_spoke_len x N bytes, e.g. 6 MB for 2048 x 1024 x 3, and
+// at most 64 MB per radar for 8192 x 1024 x MAX_REVOLUTIONS.
+class ScanIntegrator {
+public:
+    static constexpr size_t MAX_REVOLUTIONS = 8;
+
+    // revolutions (N) is clamped to 2..MAX_REVOLUTIONS
+    ScanIntegrator(size_t spokes, size_t max_spoke_len, size_t revolutions,
+                   IntegrationMode mode);
+
+    size_t GetRevolutions() const { return m_revolutions; }
+
+    // MofN: hits needed (M, clamped to 1..N), and the sample value that
+    // counts as a hit
+    void SetRequired(size_t required);
+    void SetThreshold(uint8_t threshold) { m_threshold = threshold; }
+
+    // Integrate one frame of spokes, one output spoke per input spoke.
+    // Output data is owned by the integrator and valid until the next call.
+    void Process(const SpokeData* spokes, size_t count, std::vector<SpokeData>& out);
+
+private:
+    void Integrate(const uint8_t* history, size_t rows, size_t current,
+                   size_t len, uint8_t* dst) const;
+
+    size_t m_spokes;
+    size_t m_max_spoke_len;
+    size_t m_revolutions;
+    IntegrationMode m_mode;
+    size_t m_required;
+    uint8_t m_threshold;
+
+    // Per angle: N rows of max_spoke_len, written round robin
+    std::vector<uint8_t> m_history;
+    std::vector<uint8_t> m_next;         // Row the next revolution goes to
+    std::vector<uint8_t> m_filled;       // Rows holding data
+    std::vector<uint32_t> m_range;       // Range of the rows held
+
+    // Output rows of the current Process() call
+    std::vector<uint8_t> m_rows;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _SCAN_INTEGRATOR_H_
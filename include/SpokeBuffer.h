@@ -10,31 +10,139 @@
 #define _SPOKE_BUFFER_H_
 
 #include "pi_common.h"
+#include "RadarMessageReader.h"
+#include "SpokeRing.h"
+#include "SpokeResampler.h"
+#include <atomic>
+#include <climits>
+#include <memory>
 #include <vector>
 
 PLUGIN_BEGIN_NAMESPACE
 
+// A run of consecutive spoke rows [first, first + count)
+struct DirtyRun {
+    uint32_t first;
+    uint32_t count;
+};
+
+// One complete revolution as it was received, one byte per sample on the
+// same range grid for every spoke. Immutable once published.
+struct Sweep {
+    Sweep(size_t spokes, size_t spoke_len);
+
+    uint64_t revolution;     // Counts up from 1
+    size_t spokes;
+    size_t spokeLen;
+    uint32_t gridRange;      // Range in meters of the last sample
+    uint64_t startTime;      // Unix ms of the first and last spoke
+    uint64_t endTime;
+    size_t received;         // Angles received in this revolution
+
+    // spokes x spokeLen samples. Rows not received hold stale data.
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> valid;    // Per angle: 1 if received
+
+    const uint8_t* GetRow(uint32_t angle) const { return &data[angle * spokeLen]; }
+};
+
+// Spokes arrive on the ingest thread and are queued in a lock-free
+// SpokeRing; the render thread pulls them into the texture with Drain().
+// Every row of the texture spans the same range, GetGridRange(): spokes
+// are resampled to the row width on the ingest thread, and when the
+// radar range changes the rows already stored are rescaled by Drain(),
+// so old and new spokes are never drawn at different scales.
+// The texture data and per-spoke metadata are only touched by the render
+// thread, so it never sees a half-written spoke and the ingest thread
+// never waits for a texture upload.
+//
+// Radars with no more than 16 intensity levels can be stored packed, two
+// samples per byte: sample i of a row is the low nibble of byte i / 2
+// for even i and the high nibble for odd i. This halves the texture
+// data, the queue and every upload. Samples above 15 saturate.
 class SpokeBuffer {
 public:
-    SpokeBuffer(size_t spokes, size_t max_spoke_len);
+    SpokeBuffer(size_t spokes, size_t max_spoke_len, bool packed = false);
     ~SpokeBuffer();
 
-    // Write a spoke at the given angle
+    // -------- Ingest thread --------
+
+    // Queue a spoke at the given angle, timestamped now
     void WriteSpoke(uint32_t angle, const uint8_t* data, size_t len, uint32_t range_meters);
 
-    // Read a spoke at the given angle (returns nullptr if no data)
+    // Queue a batch of spokes (one WebSocket frame). Spokes keep the time
+    // the server sent; the clock is only read for spokes without one.
+    void WriteSpokes(const SpokeData* spokes, size_t count);
+
+    // Spokes dropped because the render thread fell behind
+    uint64_t GetDroppedSpokes() const { return m_ring.GetDropped(); }
+
+    // Also assemble every revolution into a Sweep. Costs two revolutions
+    // of unpacked samples, so only enabled when something consumes them.
+    void SetSweepsEnabled(bool enabled);
+
+    // -------- Any thread --------
+
+    // The last complete revolution, nullptr before the first one. The
+    // ingest thread swaps in a new sweep by pointer when the angle wraps
+    // past the bow; a holder keeps its sweep alive and unchanged.
+    std::shared_ptr<const Sweep> GetLastSweep() const { return std::atomic_load(&m_last_sweep); }
+
+    // Number of sweeps published so far
+    uint64_t GetRevolutions() const { return m_revolutions.load(std::memory_order_acquire); }
+
+    // -------- Render thread --------
+
+    // Move queued spokes into the texture data, returns number applied
+    size_t Drain();
+
+    // Number of spokes applied by Drain() so far. Consumers that keep their
+    // own copy of the data (e.g. a GL texture) remember this value and
+    // later ask which rows changed since then.
+    uint64_t GetSequence() const { return m_sequence; }
+
+    // Angular sector written since sequence 'since': the smallest arc that
+    // follows the sweep through every spoke written, as at most two runs
+    // (a sector across angle 0 is split in two). If a full revolution or
+    // more was written it returns one run covering every row. Cost is
+    // proportional to the spokes written, not to the spokes per revolution.
+    void GetDirtySector(uint64_t since, std::vector<DirtyRun>& runs) const;
+
+    // Raw row at the given angle, GetRowBytes() long and packed if
+    // IsPacked() (returns nullptr if no data)
     const uint8_t* GetSpoke(uint32_t angle) const;
 
+    // Copy the spoke at the given angle into 'dst' as one byte per sample,
+    // GetMaxSpokeLen() bytes. Returns false if the angle is out of range.
+    bool ReadSpoke(uint32_t angle, uint8_t* dst) const;
+
     // Get spoke metadata
     size_t GetSpokeLength(uint32_t angle) const;
     uint32_t GetSpokeRange(uint32_t angle) const;
-    wxLongLong GetSpokeTime(uint32_t angle) const;
+    wxLongLong GetSpokeTime(uint32_t angle) const;   // Unix ms, 0 if none
+
+    // Spoke times in ms relative to GetTimeEpoch(), one per angle, or
+    // NO_TIME if the angle was never written. The epoch moves up once per
+    // revolution, so these stay small and a whole revolution can be
+    // scanned (e.g. for age fading) without touching the texture data.
+    static constexpr int32_t NO_TIME = INT32_MIN;
+    const int32_t* GetSpokeTimes() const { return m_spoke_times.data(); }
+    uint64_t GetTimeEpoch() const { return m_time_epoch; }
+
+    // Range in meters covered by a texture row, 0 until a spoke with a
+    // range has been drained
+    uint32_t GetGridRange() const { return m_grid_range; }
 
     // Buffer properties
     size_t GetSpokes() const { return m_spokes; }
     size_t GetMaxSpokeLen() const { return m_max_spoke_len; }
+    bool IsPacked() const { return m_packed; }
+
+    // Bytes per texture row: GetMaxSpokeLen(), or half of it rounded up
+    // when packed
+    size_t GetRowBytes() const { return m_row_bytes; }
 
-    // Clear all data
+    // Clear all data, discarding anything still queued
     void Clear();
 
     // Get raw texture data pointer (for OpenGL upload)
@@ -42,20 +150,74 @@ public:
     size_t GetTextureSize() const { return m_texture_data.size(); }
 
 private:
+    // Resample one spoke into a ring slot and publish it
+    void QueueSpoke(uint32_t angle, const uint8_t* data, size_t len,
+                    uint32_t range_meters, uint64_t now);
+
+    // Rescale every stored row from the current grid range to a new one
+    void RescaleRows(uint32_t grid_range);
+
+    // Rebase the spoke times on a new epoch
+    void SetTimeEpoch(uint64_t epoch);
+
+    // Ingest thread: copy a spoke into the sweep being built, publishing
+    // it first if the angle wrapped
+    void AddToSweep(uint32_t angle, const uint8_t* row, uint64_t time);
+    void PublishSweep();
+    void RestartSweep();
+
     size_t m_spokes;
     size_t m_max_spoke_len;
+    bool m_packed;
+    size_t m_row_bytes;
 
-    // Main data storage: spokes x max_spoke_len
+    // Network thread -> render thread
+    SpokeRing m_ring;
+
+    // Network thread: grid the queued spokes are resampled to
+    uint32_t m_queue_range;
+    SpokeResampler m_resampler;
+    std::vector<uint8_t> m_pack_row;     // Unpacked spoke before packing
+
+    // Ingest thread: revolution being assembled and the last angle seen
+    bool m_sweeps_enabled;
+    std::shared_ptr<Sweep> m_building;
+    uint32_t m_last_angle;
+
+    // Ingest thread -> any thread
+    std::shared_ptr<const Sweep> m_last_sweep;
+    std::atomic<uint64_t> m_revolutions;
+
+    // Render thread: grid of the texture data
+    uint32_t m_grid_range;
+    SpokeResampler m_rescaler;
+    std::vector<uint8_t> m_rescale_row;
+    std::vector<uint8_t> m_rescale_out;
+
+    // Main data storage: spokes x row bytes
     std::vector<uint8_t> m_texture_data;
 
-    // Per-spoke metadata
-    std::vector<size_t> m_spoke_lengths;
+    // Per-spoke metadata, one array per field so a scan of one field
+    // stays in cache: 10 bytes per spoke, 80 KB for 8192 spokes
+    std::vector<uint16_t> m_spoke_lengths;
     std::vector<uint32_t> m_spoke_ranges;
-    std::vector<wxLongLong> m_timestamps;
-
-    mutable wxCriticalSection m_lock;
+    std::vector<int32_t> m_spoke_times;
+    uint64_t m_time_epoch;               // Unix ms, 0 until the first spoke
+    uint64_t m_epoch_sequence;           // m_sequence when it was set
+
+    // Dirty tracking: angle of every drained spoke, indexed by sequence
+    // modulo m_spokes
+    uint64_t m_sequence;
+    std::vector<uint32_t> m_journal;
 };
 
+// Pack 'len' samples two per byte (even samples in the low nibble),
+// saturating at 15. 'dst' receives (len + 1) / 2 bytes.
+void PackNibbles(const uint8_t* src, size_t len, uint8_t* dst);
+
+// Unpack 'len' samples from (len + 1) / 2 packed bytes
+void UnpackNibbles(const uint8_t* src, size_t len, uint8_t* dst);
+
 PLUGIN_END_NAMESPACE
 
 #endif  // _SPOKE_BUFFER_H_
@@ -0,0 +1,70 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Merges adjacent spokes to reduce angular resolution
+ */
+
+#ifndef _SPOKE_DECIMATOR_H_
+#define _SPOKE_DECIMATOR_H_
+
+#include "pi_common.h"
+#include "RadarMessageReader.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// How the spokes of one group are combined
+enum class DecimationMode {
+    Max,        // Strongest echo of the group
+    Mean,       // Average of the group
+    PeakHold    // Max, held across revolutions with a slow decay
+};
+
+// Runs on the ingest thread between SpokeReceiver and SpokeBuffer and
+// merges every 'factor' adjacent spokes into one, so everything
+// downstream (buffer, texture, uploads) is 'factor' times smaller.
+// A radar sending 8192 spokes with factor 4 looks like a 2048 spoke radar.
+class SpokeDecimator {
+public:
+    // factor must be a power of two dividing spokes, at most 8
+    SpokeDecimator(size_t spokes, size_t factor, size_t max_spoke_len,
+                   DecimationMode mode);
+
+    size_t GetFactor() const { return m_factor; }
+    size_t GetOutputSpokes() const { return m_spokes / m_factor; }
+
+    // Merge one frame of spokes. Completed groups are returned in 'out';
+    // their data is owned by the decimator and valid until the next call.
+    // A group still missing spokes is kept for the next frame.
+    void Process(const SpokeData* spokes, size_t count, std::vector<SpokeData>& out);
+
+private:
+    void Accumulate(const SpokeData& spoke);
+    void Flush();
+
+    size_t m_spokes;
+    size_t m_factor;
+    size_t m_max_spoke_len;
+    DecimationMode m_mode;
+
+    // Group being merged
+    int64_t m_bin;               // Output angle, -1 if empty
+    size_t m_count;
+    size_t m_length;
+    SpokeData m_meta;            // Metadata of the last spoke added
+    std::vector<uint16_t> m_sum;
+    std::vector<uint8_t> m_max;
+
+    // Held value per output spoke for PeakHold
+    std::vector<uint8_t> m_hold;
+
+    // Merged spokes of the current Process() call
+    std::vector<SpokeData> m_pending;
+    std::vector<uint8_t> m_rows;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _SPOKE_DECIMATOR_H_
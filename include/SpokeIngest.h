@@ -0,0 +1,80 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Per-radar worker thread that decodes and processes spoke frames
+ */
+
+#ifndef _SPOKE_INGEST_H_
+#define _SPOKE_INGEST_H_
+
+#include "pi_common.h"
+#include "RadarMessageReader.h"
+#include "FramePool.h"
+#include "FrameQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Callback type for decoded spokes, called once per WebSocket frame with
+// all spokes of that frame (spoke.data points into the frame)
+using SpokeBatchCallback = std::function<void(const SpokeData* spokes, size_t count)>;
+
+// Decouples the WebSocket read loop from everything done with the data.
+// The socket thread only copies each frame into a pooled buffer and
+// queues it; a worker thread decodes it and runs the callback. If the
+// worker falls behind, the oldest frames are dropped instead of stalling
+// the socket. Buffers are sized from the radar's max spoke length and
+// recycled, so nothing is allocated per frame once running.
+class SpokeIngest {
+public:
+    SpokeIngest(SpokeBatchCallback callback,
+                size_t max_spoke_len,
+                size_t queue_frames = 32);
+    ~SpokeIngest();
+
+    void Start();
+    void Stop();
+
+    // Socket thread: queue one raw RadarMessage frame, never blocks on
+    // the worker
+    void Submit(const uint8_t* data, size_t len);
+
+    // Statistics
+    uint64_t GetFramesQueued() const { return m_queue.GetQueued(); }
+    uint64_t GetFramesDropped() const { return m_queue.GetDropped() + m_frames_unqueued.load(); }
+    uint64_t GetFramesProcessed() const { return m_frames_processed.load(); }
+    uint64_t GetSpokesReceived() const { return m_spokes_received.load(); }
+    uint64_t GetDecodeErrors() const { return m_decode_errors.load(); }
+
+private:
+    void Run();
+    void Process(const Frame* frame);
+
+    SpokeBatchCallback m_callback;
+    FrameQueue m_queue;
+    FramePool m_pool;
+
+    // Worker thread: decoded spokes of the current frame
+    std::vector<SpokeData> m_batch;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::mutex m_wake_lock;
+    std::condition_variable m_wake;
+
+    std::atomic<uint64_t> m_frames_processed;
+    std::atomic<uint64_t> m_frames_unqueued;    // No free buffer
+    std::atomic<uint64_t> m_spokes_received;
+    std::atomic<uint64_t> m_decode_errors;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _SPOKE_INGEST_H_
@@ -21,22 +21,14 @@ namespace ix { class WebSocket; }
 
 PLUGIN_BEGIN_NAMESPACE
 
-// Spoke data received from WebSocket
-struct SpokeData {
-    uint32_t angle;          // 0 to spokesPerRevolution-1
-    uint32_t bearing;        // Optional true bearing
-    uint32_t rangeMeters;    // Range of last pixel
-    uint64_t timestamp;      // Unix timestamp in ms
-    std::vector<uint8_t> data;  // Pixel intensities
-};
-
-// Callback type for received spokes
-using SpokeCallback = std::function<void(const SpokeData& spoke)>;
+// Callback type for received frames, called on the socket thread with one
+// raw RadarMessage. 'data' is only valid for the duration of the call.
+using FrameCallback = std::function<void(const uint8_t* data, size_t len)>;
 
 class SpokeReceiver {
 public:
     SpokeReceiver(const std::string& url,
-                  SpokeCallback callback,
+                  FrameCallback callback,
                   int reconnect_interval_ms = 5000);
     ~SpokeReceiver();
 
@@ -48,7 +40,7 @@ public:
     bool IsConnected() const { return m_connected.load(); }
 
     // Get statistics
-    uint64_t GetSpokesReceived() const { return m_spokes_received.load(); }
+    uint64_t GetFramesReceived() const { return m_frames_received.load(); }
     uint64_t GetBytesReceived() const { return m_bytes_received.load(); }
 
 private:
@@ -57,16 +49,16 @@ private:
     void OnClose();
     void OnError(const std::string& error);
     void ScheduleReconnect();
-    bool DecodeProtobuf(const std::string& data);
 
     std::unique_ptr<ix::WebSocket> m_websocket;
-    SpokeCallback m_callback;
+    FrameCallback m_callback;
+
     std::string m_url;
     int m_reconnect_interval_ms;
 
     std::atomic<bool> m_connected;
     std::atomic<bool> m_should_run;
-    std::atomic<uint64_t> m_spokes_received;
+    std::atomic<uint64_t> m_frames_received;
     std::atomic<uint64_t> m_bytes_received;
 
     std::thread m_reconnect_thread;
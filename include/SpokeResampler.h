@@ -0,0 +1,60 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Resamples spokes onto a fixed meters-per-sample grid
+ */
+
+#ifndef _SPOKE_RESAMPLER_H_
+#define _SPOKE_RESAMPLER_H_
+
+#include "pi_common.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Maps a spoke of 'len' samples spanning 'range' meters onto 'out_len'
+// samples spanning 'out_range' meters. Where the output grid is finer
+// than the spoke it interpolates linearly; where it is coarser it keeps
+// the peak of the samples each output covers, so small targets survive
+// decimation. Output beyond the spoke's range is zero.
+//
+// Index tables are cached for the last geometry, which is the same for
+// almost every spoke. Not thread safe; use one instance per thread.
+class SpokeResampler {
+public:
+    SpokeResampler();
+
+    // Returns the number of output samples covered by the spoke
+    size_t Resample(const uint8_t* src, size_t len, uint32_t range,
+                    uint8_t* dst, size_t out_len, uint32_t out_range);
+
+private:
+    void Prepare(size_t len, uint32_t range, size_t out_len, uint32_t out_range);
+    void SlidingMax(const uint8_t* src, size_t len);
+
+    // Cached geometry
+    size_t m_len;
+    uint32_t m_range;
+    size_t m_out_len;
+    uint32_t m_out_range;
+
+    bool m_decimate;
+    size_t m_valid;                  // Outputs inside the spoke's range
+
+    // Linear: source index and 8-bit weight of the next sample
+    std::vector<uint32_t> m_index;
+    std::vector<uint16_t> m_weight;
+
+    // Peak-hold: every output takes the max over a window of m_window
+    // samples starting at m_index[j]; m_scratch holds the running max
+    // over m_pow2 samples, the largest power of two <= m_window
+    size_t m_window;
+    size_t m_pow2;
+    std::vector<uint8_t> m_scratch;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _SPOKE_RESAMPLER_H_
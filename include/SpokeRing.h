@@ -0,0 +1,73 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Lock-free single-producer/single-consumer queue of spoke slots
+ */
+
+#ifndef _SPOKE_RING_H_
+#define _SPOKE_RING_H_
+
+#include "pi_common.h"
+#include <atomic>
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// One queued spoke. 'data' points at the slot's own fixed-size payload
+// of GetPayloadLen() bytes, owned by the ring.
+struct SpokeSlot {
+    uint32_t angle;
+    uint32_t rangeMeters;    // Range of the spoke as received
+    uint32_t gridRange;      // Range the payload was resampled to
+    uint64_t timestamp;
+    uint32_t length;         // Valid bytes in data
+    uint8_t* data;
+};
+
+// Fixed-capacity ring between the ingest thread (producer) and the
+// render thread (consumer). Neither side ever blocks: the producer gets
+// nullptr from BeginWrite() when the ring is full and drops the spoke.
+//
+// Producer:  SpokeSlot* s = ring.BeginWrite(); fill s; ring.CommitWrite();
+// Consumer:  while (const SpokeSlot* s = ring.BeginRead()) { use s; ring.EndRead(); }
+class SpokeRing {
+public:
+    // capacity is rounded up to a power of two
+    SpokeRing(size_t capacity, size_t payload_len);
+    ~SpokeRing();
+
+    // -------- Producer side --------
+    SpokeSlot* BeginWrite();
+    void CommitWrite();
+
+    // -------- Consumer side --------
+    const SpokeSlot* BeginRead();
+    void EndRead();
+
+    size_t GetCapacity() const { return m_mask + 1; }
+    size_t GetPayloadLen() const { return m_payload_len; }
+
+    // Spokes dropped because the consumer fell a full ring behind
+    uint64_t GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    size_t m_mask;
+    size_t m_payload_len;
+
+    std::vector<SpokeSlot> m_slots;
+    std::vector<uint8_t> m_payload;
+
+    // Head and tail on separate cache lines so the two threads don't
+    // false-share
+    alignas(64) std::atomic<size_t> m_head;  // Next slot to write (producer)
+    size_t m_cached_tail;                    // Producer's view of m_tail
+    alignas(64) std::atomic<size_t> m_tail;  // Next slot to read (consumer)
+    size_t m_cached_head;                    // Consumer's view of m_head
+    alignas(64) std::atomic<uint64_t> m_dropped;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _SPOKE_RING_H_
@@ -0,0 +1,73 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Uniform grid index over target positions
+ */
+
+#ifndef _TARGET_INDEX_H_
+#define _TARGET_INDEX_H_
+
+#include "pi_common.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Points bucketed into a uniform grid, for nearest point queries and
+// overlap tests without comparing every pair. Coordinates are any 2D
+// space, e.g. screen pixels or meters east and north; the cell size is
+// best about the query radius.
+//
+// Build() is a counting sort of the points by cell, O(n), and a query
+// only visits the cells its radius or box covers.
+class TargetIndex {
+public:
+    TargetIndex();
+
+    // Index the points, replacing the previous ones. Points that aren't
+    // finite are never found and get no label.
+    void Build(const float* x, const float* y, size_t count, float cell);
+
+    size_t size() const { return m_x.size(); }
+
+    // Index of the point nearest to (x, y) within max_distance, or -1
+    int Nearest(float x, float y, float max_distance) const;
+
+    // Place a w x h label beside every point, in the given order: right
+    // of it, then left, above and below, at 'gap' from the point. A label
+    // is shown only where it overlaps no label placed before it and no
+    // point (drawn with 'symbol' radius) other than its own. 'left' and
+    // 'top' receive each label's corner, 'shown' 1 where it was placed.
+    void PlaceLabels(const std::vector<uint32_t>& order, float w, float h,
+                     float gap, float symbol,
+                     std::vector<float>& left, std::vector<float>& top,
+                     std::vector<uint8_t>& shown);
+
+private:
+    int CellX(float x) const;
+    int CellY(float y) const;
+
+    // Calls f(point) for the points in the cells covering the box
+    template <typename F>
+    void ForEachInBox(float x0, float y0, float x1, float y1, F f) const;
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+
+    // Grid over the bounding box of the points
+    float m_cell;
+    float m_origin_x;
+    float m_origin_y;
+    int m_columns;
+    int m_rows;
+    std::vector<uint32_t> m_cell_start;  // Points of cell c: [start[c], start[c + 1])
+    std::vector<uint32_t> m_points;      // Point indices sorted by cell
+
+    // Labels placed so far, bucketed by the cell of their corner
+    std::vector<std::vector<uint32_t>> m_label_cells;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _TARGET_INDEX_H_
@@ -0,0 +1,72 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * WebSocket client for the ARPA target stream of mayara-server
+ */
+
+#ifndef _TARGET_RECEIVER_H_
+#define _TARGET_RECEIVER_H_
+
+#include "pi_common.h"
+#include "TargetTable.h"
+#include <string>
+#include <atomic>
+#include <memory>
+
+// Forward declare IXWebSocket types
+namespace ix { class WebSocket; }
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Applies the target stream to a TargetTable as it arrives, replacing
+// REST polling. Every text message is one JSON document:
+//
+//   {"targets": [...]}             the full list, replacing the table
+//   {...target...}, [{...}, ...]   targets added or updated
+//   {"targetId": n, "status": "lost"} (or "type": "lost"/"removed")
+//                                  a target that is gone
+//
+// Target fields are named as in the REST API. The table is published
+// once per message, on the socket thread, and cleared when the
+// connection closes so no stale targets are shown.
+class TargetReceiver {
+public:
+    TargetReceiver(const std::string& url, TargetTable* table);
+    ~TargetReceiver();
+
+    // Start/stop the WebSocket connection
+    void Start();
+    void Stop();
+
+    // Connection status
+    bool IsConnected() const { return m_connected.load(); }
+
+    // Get statistics
+    uint64_t GetMessagesReceived() const { return m_messages_received.load(); }
+    uint64_t GetParseErrors() const { return m_parse_errors.load(); }
+
+    // Apply one message to the table and publish it; false if it was not
+    // valid JSON
+    bool Apply(const std::string& message);
+
+private:
+    void OnOpen();
+    void OnClose();
+    void OnError(const std::string& error);
+    void ScheduleReconnect();
+
+    std::unique_ptr<ix::WebSocket> m_websocket;
+    TargetTable* m_table;
+    std::string m_url;
+
+    std::atomic<bool> m_connected;
+    std::atomic<bool> m_should_run;
+    std::atomic<uint64_t> m_messages_received;
+    std::atomic<uint64_t> m_parse_errors;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _TARGET_RECEIVER_H_
@@ -0,0 +1,69 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Versioned table of ARPA targets with immutable snapshots
+ */
+
+#ifndef _TARGET_TABLE_H_
+#define _TARGET_TABLE_H_
+
+#include "pi_common.h"
+#include "MayaraClient.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Targets keyed by targetId, changed one target at a time and published
+// as a whole. Writers batch changes and call Publish() once per batch,
+// which copies the table into a new immutable list sorted by targetId
+// and bumps the version. Readers take that list by pointer without
+// waiting for writers, and keep it unchanged for as long as they hold it.
+class TargetTable {
+public:
+    TargetTable();
+
+    // -------- Writers --------
+
+    // Add a target or replace the one with the same targetId
+    void Upsert(const ArpaTarget& target);
+
+    // Remove a target, e.g. when it is lost
+    void Remove(int target_id);
+
+    // Replace every target
+    void Assign(const std::vector<ArpaTarget>& targets);
+    void Clear();
+
+    // Make the changes since the last call visible, if there were any
+    void Publish();
+
+    // -------- Any thread --------
+
+    // Targets as of the last Publish(), never nullptr
+    std::shared_ptr<const std::vector<ArpaTarget>> GetTargets() const {
+        return std::atomic_load(&m_published);
+    }
+
+    // Counts Publish() calls that changed something, so a reader can tell
+    // whether its copy is current
+    uint64_t GetVersion() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    std::vector<ArpaTarget>::iterator Find(int target_id);
+
+    std::mutex m_write_lock;
+    std::vector<ArpaTarget> m_targets;   // Sorted by targetId
+    bool m_changed;
+
+    std::shared_ptr<const std::vector<ArpaTarget>> m_published;
+    std::atomic<uint64_t> m_version;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _TARGET_TABLE_H_
@@ -0,0 +1,148 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Local target tracking on detected blobs
+ */
+
+#ifndef _TARGET_TRACKER_H_
+#define _TARGET_TRACKER_H_
+
+#include "pi_common.h"
+#include "BlobDetector.h"
+#include "MayaraClient.h"
+#include "OwnShip.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Follows targets from sweep to sweep with an alpha-beta filter per
+// track, in meters east and north of a fixed anchor so positions and
+// velocities are over ground.
+//
+// Every update the blobs are placed in a uniform grid, found by sorting
+// their cell keys, and each track only looks at the 3 x 3 cells around
+// its predicted position. Track and blob pairs inside the gate are
+// assigned nearest first, so an update costs O((tracks + blobs) log blobs).
+//
+// Tracks start from acquisitions (relative bearing and distance, as
+// clicked) or, with auto acquisition, from every unassigned blob; the
+// latter are only reported once confirmed. Tracks coast while unseen and
+// are dropped after MAX_MISSES sweeps. Published targets have true
+// bearings and courses.
+//
+// SetOwnShip(), Acquire() and Cancel() may be called from any thread and
+// only queue their input. Update() runs on one thread, once per sweep,
+// and publishes the targets as an immutable list.
+class TargetTracker {
+public:
+    static constexpr uint32_t MAX_MISSES = 5;
+    static constexpr uint32_t CONFIRM_HITS = 3;
+
+    TargetTracker();
+
+    // -------- Any thread --------
+
+    // Own ship from the latest position fix: heading in degrees true (NaN
+    // falls back to COG), COG in degrees and SOG in knots
+    void SetOwnShip(const GeoPosition& position, double heading, double cog, double sog);
+
+    // Start tracking the blob nearest to a bearing relative to the bow
+    // (degrees, as clicked on the PPI) and distance (meters) from own
+    // ship, at the next sweep
+    void Acquire(double bearing, double distance);
+    void Cancel(int target_id);
+
+    // Track every blob, not only acquired ones
+    void SetAutoAcquire(bool enabled);
+
+    // Targets as of the last update, never nullptr
+    std::shared_ptr<const std::vector<ArpaTarget>> GetTargets() const {
+        return std::atomic_load(&m_targets);
+    }
+
+    // -------- Tracking thread --------
+
+    void Update(const BlobList& blobs);
+
+    size_t GetTrackCount() const { return m_id.size(); }
+
+private:
+    struct Acquisition {
+        double bearing;
+        double distance;
+        uint32_t sweeps;         // Sweeps it waited for a blob
+    };
+
+    struct Candidate {
+        float distance2;
+        uint32_t track;
+        uint32_t blob;
+        bool operator<(const Candidate& other) const { return distance2 < other.distance2; }
+    };
+
+    void TakeInput();
+    void UpdateOwnShip();
+    void PlaceBlobs(const BlobList& blobs);
+    void BuildGrid(double cell);
+    template <typename F> void ForEachNearBlob(double x, double y, F f) const;
+    void Associate(double dt);
+    void StartTracks(const BlobList& blobs);
+    void AddTrack(uint32_t blob, bool manual);
+    void DropTracks();
+    void Publish();
+
+    // Input queued by other threads
+    std::mutex m_input_lock;
+    OwnShip m_own_ship;
+    bool m_auto_acquire;
+    std::vector<Acquisition> m_acquire_queue;
+    std::vector<int> m_cancel_queue;
+
+    // Own ship at the sweep, copied from the input
+    OwnShip m_ship;
+    bool m_tracking_all;
+    std::vector<Acquisition> m_acquisitions;
+
+    // Local frame: meters east (x) and north (y) of the anchor
+    GeoPosition m_anchor;
+    bool m_anchored;
+    double m_ship_x;
+    double m_ship_y;
+    double m_ship_vx;                    // m/s
+    double m_ship_vy;
+    double m_heading;                    // Degrees true
+
+    // Tracks, one entry per track in each array
+    std::vector<int> m_id;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+    std::vector<uint32_t> m_hits;
+    std::vector<uint32_t> m_misses;
+    std::vector<uint8_t> m_manual;
+    uint64_t m_time;                     // Unix ms of the last sweep
+    int m_next_id;
+
+    // Scratch for one update
+    std::vector<double> m_blob_x;
+    std::vector<double> m_blob_y;
+    std::vector<uint8_t> m_blob_used;
+    std::vector<uint32_t> m_blob_track;  // Track assigned to each blob
+    std::vector<uint8_t> m_track_hit;
+    std::vector<double> m_gates;
+    std::vector<std::pair<uint64_t, uint32_t>> m_grid;   // Cell key, blob
+    double m_cell;
+    double m_gate_base;
+    std::vector<Candidate> m_candidates;
+
+    std::shared_ptr<const std::vector<ArpaTarget>> m_targets;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _TARGET_TRACKER_H_
@@ -0,0 +1,148 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Target trail history as a per-cell age grid
+ */
+
+#ifndef _TRAIL_BUFFER_H_
+#define _TRAIL_BUFFER_H_
+
+#include "pi_common.h"
+#include "SpokeBuffer.h"
+#include "OwnShip.h"
+#include <vector>
+
+PLUGIN_BEGIN_NAMESPACE
+
+enum class TrailMode {
+    Off,
+    Relative,    // Grid moves with own ship: trails show relative motion
+    TrueMotion   // Grid is fixed to the earth: stationary echoes leave none
+};
+
+// Square north-up grid of cells around own ship, each holding the time
+// stamp of the last echo seen in it, so its age is the trail age.
+//
+// The grid spans the radar disk, 2 x GetGridRange() of the SpokeBuffer,
+// and is addressed toroidally: world cell (x, y) lives at
+// (x mod size, y mod size). In true motion the window follows the ship by
+// whole cells without moving memory, only the cells scrolling in are
+// cleared. World cells are counted from an anchor taken at the first fix
+// and moved by whole grid spans once own ship is far from it. A range
+// change clears the trails.
+//
+// Update() only scans the spokes drained since the previous call, so its
+// cost follows the spokes received, not the grid size. Stamps count
+// TICK_MS ticks and wrap at 16 bits; a slice of rows is expired on every
+// update so a stamp is cleared long before it could wrap and look new.
+//
+// Touches no GL or wx UI state; call Update() on the thread that drains
+// the SpokeBuffer, after Drain().
+class TrailBuffer {
+public:
+    static constexpr uint32_t TICK_MS = 100;
+
+    // Trails longer than this are cut short by the expiry scan
+    static constexpr uint32_t MAX_LENGTH_TICKS = 18000;   // 30 minutes
+
+    explicit TrailBuffer(size_t size = 512);
+    ~TrailBuffer();
+
+    void SetMode(TrailMode mode);
+    TrailMode GetMode() const { return m_mode; }
+
+    // Echoes at or above this sample value leave a trail
+    void SetThreshold(uint8_t threshold) { m_threshold = threshold; }
+
+    // Own ship from the latest position fix: heading in degrees true (NaN
+    // falls back to COG), COG in degrees and SOG in knots. Between fixes
+    // the position is dead reckoned from COG and SOG.
+    void SetOwnShip(const GeoPosition& position, double heading, double cog, double sog);
+
+    // Stamp the cells under every echo drained since the last call, scroll
+    // the grid with own ship and expire a slice of old stamps
+    void Update(SpokeBuffer* buffer);
+
+    // Clear all trails
+    void Clear();
+
+    // Grid properties
+    size_t GetSize() const { return m_size; }
+    const uint16_t* GetStamps() const { return m_stamps.data(); }
+    double GetCellMeters() const { return m_cell_meters; }
+
+    // Current tick, the stamp an echo seen now gets (never 0, which marks
+    // an empty cell)
+    uint16_t GetNow() const { return m_now; }
+
+    // Own ship in grid cells, x east and y south, including the fraction
+    // within its cell. Texel (x mod size, y mod size) is the ship's cell.
+    double GetShipX() const { return m_ship_x; }
+    double GetShipY() const { return m_ship_y; }
+
+    // Heading the spokes were last placed with, degrees true
+    double GetHeading() const { return m_heading; }
+
+    // Consumers keeping a copy (e.g. a GL texture) remember
+    // GetGeneration() and later copy the rows whose GetRowGeneration() is
+    // newer
+    uint32_t GetGeneration() const { return m_generation; }
+    const uint32_t* GetRowGenerations() const { return m_row_generation.data(); }
+
+    // Cells stamped by the last Update(), to verify incremental updates
+    size_t GetLastCellCount() const { return m_last_cell_count; }
+
+private:
+    void StampSpoke(const uint8_t* samples, float step_x, float step_y);
+    void Reanchor(double east, double north);
+    void Scroll(int64_t cell_x, int64_t cell_y);
+    void ClearColumn(int64_t x);
+    void ClearRow(int64_t y);
+    void Expire();
+    void TouchRow(size_t row) { m_row_generation[row] = m_generation; }
+
+    size_t m_size;
+    size_t m_mask;
+    TrailMode m_mode;
+    uint8_t m_threshold;
+
+    // Stamps, row major, row 0 north
+    std::vector<uint16_t> m_stamps;
+    std::vector<uint32_t> m_row_generation;
+    uint32_t m_generation;
+
+    // Spoke geometry the grid was built for
+    size_t m_spokes;
+    size_t m_spoke_len;
+    uint32_t m_grid_range;
+    double m_cell_meters;
+    std::vector<float> m_sin;           // Per spoke, unit bearing at heading 0
+    std::vector<float> m_cos;
+    std::vector<uint8_t> m_unpacked;    // Scratch for packed rows
+
+    // Own ship
+    OwnShip m_own_ship;
+    GeoPosition m_anchor;               // World cell (0, 0), true motion
+    bool m_anchored;
+    double m_ship_x;
+    double m_ship_y;
+    int64_t m_window_x;                 // World cell of the ship's texel
+    int64_t m_window_y;
+    double m_heading;                   // Applied to the spokes, degrees
+
+    // Time
+    uint64_t m_tick;
+    uint16_t m_now;
+    uint64_t m_expired_tick;            // Tick the expiry scan reached
+    size_t m_expire_row;
+
+    uint64_t m_sequence;
+    std::vector<DirtyRun> m_dirty_runs;
+    size_t m_last_cell_count;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif  // _TRAIL_BUFFER_H_
@@ -63,6 +63,19 @@ extern PFNGLUNIFORM2FPROC          glUniform2f_ptr;
 extern PFNGLUNIFORM3FPROC          glUniform3f_ptr;
 extern PFNGLUNIFORM4FPROC          glUniform4f_ptr;
 extern PFNGLUNIFORMMATRIX4FVPROC   glUniformMatrix4fv_ptr;
+extern PFNGLGETATTRIBLOCATIONPROC  glGetAttribLocation_ptr;
+extern PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer_ptr;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray_ptr;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray_ptr;
+extern PFNGLACTIVETEXTUREPROC      glActiveTexture_ptr;
+
+// Buffer objects (pixel buffer upload)
+extern PFNGLGENBUFFERSPROC         glGenBuffers_ptr;
+extern PFNGLDELETEBUFFERSPROC      glDeleteBuffers_ptr;
+extern PFNGLBINDBUFFERPROC         glBindBuffer_ptr;
+extern PFNGLBUFFERDATAPROC         glBufferData_ptr;
+extern PFNGLMAPBUFFERPROC          glMapBuffer_ptr;
+extern PFNGLUNMAPBUFFERPROC        glUnmapBuffer_ptr;
 
 // Redefine GL functions to use pointers
 #define glCreateShader       glCreateShader_ptr
@@ -85,13 +98,28 @@ extern PFNGLUNIFORMMATRIX4FVPROC   glUniformMatrix4fv_ptr;
 #define glUniform3f          glUniform3f_ptr
 #define glUniform4f          glUniform4f_ptr
 #define glUniformMatrix4fv   glUniformMatrix4fv_ptr
+#define glGetAttribLocation  glGetAttribLocation_ptr
+#define glVertexAttribPointer glVertexAttribPointer_ptr
+#define glEnableVertexAttribArray glEnableVertexAttribArray_ptr
+#define glDisableVertexAttribArray glDisableVertexAttribArray_ptr
+#define glActiveTexture      glActiveTexture_ptr
+#define glGenBuffers         glGenBuffers_ptr
+#define glDeleteBuffers      glDeleteBuffers_ptr
+#define glBindBuffer         glBindBuffer_ptr
+#define glBufferData         glBufferData_ptr
+#define glMapBuffer          glMapBuffer_ptr
+#define glUnmapBuffer        glUnmapBuffer_ptr
 
 // Initialize OpenGL extension functions - call once before using shaders
 bool InitGLFunctions();
 
+// True if the buffer object functions needed for PBO uploads were loaded
+bool HaveGLBufferFunctions();
+
 #else
 // On other platforms, functions are directly available
 inline bool InitGLFunctions() { return true; }
+inline bool HaveGLBufferFunctions() { return true; }
 #endif
 
 #endif  // _GL_FUNCS_H_
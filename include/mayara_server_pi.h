@@ -54,6 +54,11 @@ public:
                                      PlugIn_ViewPort* vp,
                                      int canvasIndex) override;
 
+    // -------- Non-GL overlay rendering --------
+    bool RenderOverlayMultiCanvas(wxDC& dc,
+                                  PlugIn_ViewPort* vp,
+                                  int canvasIndex) override;
+
     // -------- Position updates --------
     void SetPositionFixEx(PlugIn_Position_Fix_Ex& pfix) override;
 
@@ -72,6 +77,19 @@ public:
     int GetReconnectInterval() const { return m_reconnect_interval; }
     bool GetShowOverlay() const { return m_show_overlay; }
     bool GetShowPPIWindow() const { return m_show_ppi_window; }
+    bool GetPBOUpload() const { return m_pbo_upload; }
+    bool GetPolarLookup() const { return m_polar_lookup; }
+    int GetSpokeDecimation() const { return m_spoke_decimation; }
+    int GetDecimationMode() const { return m_decimation_mode; }
+    double GetAfterglow() const { return m_afterglow; }
+    int GetTrailMode() const { return m_trail_mode; }
+    int GetTrailLength() const { return m_trail_length; }
+    int GetIntegrationMode() const { return m_integration_mode; }
+    int GetIntegrationRevolutions() const { return m_integration_revolutions; }
+    int GetIntegrationRequired() const { return m_integration_required; }
+    bool GetLocalDetection() const { return m_local_detection; }
+    double GetDetectionThreshold() const { return m_detection_threshold; }
+    bool GetAutoAcquire() const { return m_auto_acquire; }
 
     void SetServerHost(const std::string& host) { m_server_host = host; }
     void SetServerPort(int port) { m_server_port = port; }
@@ -79,10 +97,25 @@ public:
     void SetReconnectInterval(int interval) { m_reconnect_interval = interval; }
     void SetShowOverlay(bool show) { m_show_overlay = show; }
     void SetShowPPIWindow(bool show) { m_show_ppi_window = show; }
+    void SetPBOUpload(bool use) { m_pbo_upload = use; }
+    void SetPolarLookup(bool use) { m_polar_lookup = use; }
+    void SetSpokeDecimation(int factor) { m_spoke_decimation = factor; }
+    void SetDecimationMode(int mode) { m_decimation_mode = mode; }
+    void SetAfterglow(double time_constant) { m_afterglow = time_constant; }
+    void SetTrailMode(int mode) { m_trail_mode = mode; }
+    void SetTrailLength(int seconds) { m_trail_length = seconds; }
+    void SetIntegrationMode(int mode) { m_integration_mode = mode; }
+    void SetIntegrationRevolutions(int revolutions) { m_integration_revolutions = revolutions; }
+    void SetIntegrationRequired(int required) { m_integration_required = required; }
+    void SetLocalDetection(bool detect) { m_local_detection = detect; }
+    void SetDetectionThreshold(double factor) { m_detection_threshold = factor; }
+    void SetAutoAcquire(bool enabled) { m_auto_acquire = enabled; }
 
     // Position accessors
     GeoPosition GetOwnPosition() const { return m_own_position; }
     double GetHeading() const { return m_heading; }
+    double GetCog() const { return m_cog; }
+    double GetSog() const { return m_sog; }
     bool IsPositionValid() const { return m_position_valid; }
 
     // Radar manager accessor
@@ -105,6 +138,19 @@ private:
     int m_reconnect_interval;
     bool m_show_overlay;
     bool m_show_ppi_window;
+    bool m_pbo_upload;
+    bool m_polar_lookup;
+    int m_spoke_decimation;     // Spokes merged into one, 1 = off
+    int m_decimation_mode;      // mayara::DecimationMode
+    double m_afterglow;         // Echo fade time constant in seconds, 0 = off
+    int m_trail_mode;           // mayara::TrailMode
+    int m_trail_length;         // Seconds
+    int m_integration_mode;     // 0 = off, else mayara::IntegrationMode + 1
+    int m_integration_revolutions;
+    int m_integration_required; // M of M-of-N
+    bool m_local_detection;
+    double m_detection_threshold;   // CFAR factor over the local mean
+    bool m_auto_acquire;            // Track every detected blob
 
     // Radar management
     std::unique_ptr<mayara::RadarManager> m_radar_manager;
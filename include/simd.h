@@ -0,0 +1,59 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Compile time selection of the SIMD code paths
+ */
+
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+// MAYARA_SSE2 or MAYARA_NEON is defined when the target always has that
+// instruction set, and pulls in its intrinsics. GCC and Clang define
+// __SSE2__ on x86-64 (and x86 with -msse2); MSVC never does, but SSE2 is
+// part of x64 and enabled by /arch:SSE2 or higher on x86.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAYARA_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define MAYARA_NEON 1
+#include <arm_neon.h>
+#endif
+
+// x86 kernels for instruction sets above that baseline are compiled per
+// function with MAYARA_TARGET_AVX2, so no build flags are needed, and may
+// only be called when HasAVX2() says the CPU and OS support them
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MAYARA_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MAYARA_TARGET_AVX2
+#else
+#define MAYARA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+inline bool HasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    static const bool has_avx2 = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        // AVX and OSXSAVE, then the OS saving the YMM registers
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+        if ((_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return has_avx2;
+#else
+    // Checks OS support of the YMM registers too
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#endif
+}
+#endif
+
+#endif  // _SIMD_H_
@@ -0,0 +1,320 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * CFAR target detection on complete sweeps
+ */
+
+#include "BlobDetector.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+using namespace mayara;
+
+static const uint32_t NO_COMPONENT = UINT32_MAX;
+
+void BlobList::clear() {
+    angle.clear();
+    range.clear();
+    angleFirst.clear();
+    angleCount.clear();
+    rangeFirst.clear();
+    rangeCount.clear();
+    peak.clear();
+    cells.clear();
+}
+
+BlobDetector::BlobDetector()
+    : m_window(16)
+    , m_guard(2)
+    , m_factor(3.0f)
+    , m_noise_floor(1)
+    , m_min_range(0)
+    , m_min_cells(2)
+    , m_max_cells(20000)
+{
+}
+
+void BlobDetector::SetWindow(size_t window, size_t guard) {
+    m_window = std::max<size_t>(window, 1);
+    m_guard = guard;
+}
+
+void BlobDetector::SetBlobCells(size_t min_cells, size_t max_cells) {
+    m_min_cells = std::max<size_t>(min_cells, 1);
+    m_max_cells = std::max(max_cells, m_min_cells);
+}
+
+void BlobDetector::Detect(const Sweep& sweep, BlobList& blobs) {
+    const size_t spokes = sweep.spokes;
+    const size_t len = std::min<size_t>(sweep.spokeLen, UINT16_MAX);
+
+    blobs.clear();
+    blobs.revolution = sweep.revolution;
+    blobs.time = sweep.startTime + (sweep.endTime - sweep.startTime) / 2;
+    blobs.spokes = spokes;
+    blobs.spokeLen = sweep.spokeLen;
+    blobs.gridRange = sweep.gridRange;
+    if (spokes == 0 || len == 0) return;
+
+    m_prefix.resize(len + 1);
+    m_hits.resize(len);
+    m_run_angle.clear();
+    m_run_start.clear();
+    m_run_end.clear();
+    m_run_weight.clear();
+    m_run_moment.clear();
+    m_run_peak.clear();
+    m_spoke_runs.resize(spokes + 1);
+
+    for (uint32_t angle = 0; angle < spokes; angle++) {
+        m_spoke_runs[angle] = m_run_angle.size();
+        if (!sweep.valid[angle]) continue;
+        const uint8_t* row = sweep.GetRow(angle);
+        DetectRow(row, len);
+        ExtractRuns(angle, row, len);
+    }
+    m_spoke_runs[spokes] = m_run_angle.size();
+
+    // Label: every run starts as its own component
+    const size_t runs = m_run_angle.size();
+    m_parent.resize(runs);
+    std::iota(m_parent.begin(), m_parent.end(), 0);
+    for (size_t angle = 1; angle < spokes; angle++) {
+        JoinRuns(m_spoke_runs[angle - 1], m_spoke_runs[angle],
+                 m_spoke_runs[angle], m_spoke_runs[angle + 1]);
+    }
+    if (spokes > 2) {
+        JoinRuns(m_spoke_runs[spokes - 1], m_spoke_runs[spokes],
+                 m_spoke_runs[0], m_spoke_runs[1]);
+    }
+
+    // Sum up the runs of every component. Runs come in spoke order, so a
+    // component's reference angle is the first spoke it was seen on.
+    m_components.clear();
+    m_component_of_root.assign(runs, NO_COMPONENT);
+    const int32_t half = (int32_t)(spokes / 2);
+    for (uint32_t run = 0; run < runs; run++) {
+        uint32_t root = Find(run);
+        uint32_t index = m_component_of_root[root];
+        if (index == NO_COMPONENT) {
+            index = (uint32_t)m_components.size();
+            m_component_of_root[root] = index;
+            Component c;
+            c.refAngle = m_run_angle[run];
+            c.minDelta = 0;
+            c.maxDelta = 0;
+            c.rangeFirst = m_run_start[run];
+            c.rangeEnd = m_run_end[run];
+            c.peak = 0;
+            c.cells = 0;
+            c.weight = 0;
+            c.angleMoment = 0.0;
+            c.rangeMoment = 0;
+            m_components.push_back(c);
+        }
+        Component& c = m_components[index];
+
+        int32_t delta = (int32_t)m_run_angle[run] - (int32_t)c.refAngle;
+        if (delta >= half) delta -= (int32_t)spokes;
+        if (delta < -half) delta += (int32_t)spokes;
+        c.minDelta = std::min(c.minDelta, delta);
+        c.maxDelta = std::max(c.maxDelta, delta);
+        c.rangeFirst = std::min(c.rangeFirst, m_run_start[run]);
+        c.rangeEnd = std::max(c.rangeEnd, m_run_end[run]);
+        c.peak = std::max(c.peak, m_run_peak[run]);
+        c.cells += m_run_end[run] - m_run_start[run];
+        c.weight += m_run_weight[run];
+        c.angleMoment += (double)delta * m_run_weight[run];
+        c.rangeMoment += m_run_moment[run];
+    }
+
+    for (const Component& c : m_components) {
+        if (c.cells < m_min_cells || c.cells > m_max_cells || c.weight == 0) continue;
+
+        double angle = c.refAngle + c.angleMoment / (double)c.weight;
+        if (angle < 0.0) angle += spokes;
+        if (angle >= (double)spokes) angle -= spokes;
+        int32_t first = (int32_t)c.refAngle + c.minDelta;
+        if (first < 0) first += (int32_t)spokes;
+
+        // Sample i covers [i, i + 1), so its center is at i + 0.5
+        blobs.angle.push_back((float)angle);
+        blobs.range.push_back((float)((double)c.rangeMoment / (double)c.weight + 0.5));
+        blobs.angleFirst.push_back((uint32_t)first);
+        blobs.angleCount.push_back((uint32_t)(c.maxDelta - c.minDelta + 1));
+        blobs.rangeFirst.push_back(c.rangeFirst);
+        blobs.rangeCount.push_back((uint16_t)(c.rangeEnd - c.rangeFirst));
+        blobs.peak.push_back(c.peak);
+        blobs.cells.push_back(c.cells);
+    }
+}
+
+void BlobDetector::DetectRow(const uint8_t* row, size_t len) {
+    const size_t guard = m_guard;
+    const size_t window = m_window;
+    uint32_t* prefix = m_prefix.data();
+    uint8_t* hits = m_hits.data();
+
+    prefix[0] = 0;
+    for (size_t i = 0; i < len; i++) {
+        prefix[i + 1] = prefix[i] + row[i];
+    }
+
+    size_t begin = std::min(m_min_range, len);
+    std::memset(hits, 0, begin);
+
+    // Samples with both reference windows complete: [full_begin, full_end)
+    size_t full_begin = std::max(begin, guard + window);
+    size_t full_end = len > guard + window ? len - guard - window : 0;
+    full_end = std::max(full_end, full_begin);
+    full_begin = std::min(full_begin, len);
+    full_end = std::min(full_end, len);
+
+    // Near the ends of the spoke, average what there is of the windows
+    auto edge = [&](size_t i) -> uint8_t {
+        size_t lead_end = i >= guard ? i - guard : 0;
+        size_t lead_begin = i >= guard + window ? i - guard - window : 0;
+        size_t lag_begin = std::min(i + guard + 1, len);
+        size_t lag_end = std::min(i + guard + 1 + window, len);
+        size_t n = (lead_end - lead_begin) + (lag_end - lag_begin);
+        if (n == 0 || row[i] < m_noise_floor) return 0;
+        uint32_t sum = prefix[lead_end] - prefix[lead_begin] + prefix[lag_end] - prefix[lag_begin];
+        return (float)row[i] > (float)sum * (m_factor / n) ? 0xFF : 0;
+    };
+
+    size_t i = begin;
+    for (; i < full_begin; i++) {
+        hits[i] = edge(i);
+    }
+
+    // x > factor * sum / (2 * window), in float so the sums never overflow
+    const float scale = m_factor / (float)(2 * window);
+#if defined(MAYARA_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128i floor = _mm_set1_epi8((char)m_noise_floor);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= full_end; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i x16[2] = { _mm_unpacklo_epi8(x, zero), _mm_unpackhi_epi8(x, zero) };
+        __m128i mask[4];
+        for (size_t k = 0; k < 4; k++) {
+            const uint32_t* p = prefix + i + 4 * k;
+            __m128i lead = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(p - guard)),
+                                         _mm_loadu_si128((const __m128i*)(p - guard - window)));
+            __m128i lag = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(p + guard + 1 + window)),
+                                        _mm_loadu_si128((const __m128i*)(p + guard + 1)));
+            __m128 noise = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(lead, lag)), vscale);
+            __m128i xi = (k & 1) ? _mm_unpackhi_epi16(x16[k >> 1], zero)
+                                 : _mm_unpacklo_epi16(x16[k >> 1], zero);
+            mask[k] = _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(xi), noise));
+        }
+        __m128i m = _mm_packs_epi16(_mm_packs_epi32(mask[0], mask[1]),
+                                    _mm_packs_epi32(mask[2], mask[3]));
+        m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_max_epu8(x, floor), x));
+        _mm_storeu_si128((__m128i*)(hits + i), m);
+    }
+#elif defined(MAYARA_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    const uint8x16_t floor = vdupq_n_u8(m_noise_floor);
+    for (; i + 16 <= full_end; i += 16) {
+        uint8x16_t x = vld1q_u8(row + i);
+        uint16x8_t x16[2] = { vmovl_u8(vget_low_u8(x)), vmovl_u8(vget_high_u8(x)) };
+        uint32x4_t mask[4];
+        for (size_t k = 0; k < 4; k++) {
+            const uint32_t* p = prefix + i + 4 * k;
+            uint32x4_t lead = vsubq_u32(vld1q_u32(p - guard), vld1q_u32(p - guard - window));
+            uint32x4_t lag = vsubq_u32(vld1q_u32(p + guard + 1 + window), vld1q_u32(p + guard + 1));
+            float32x4_t noise = vmulq_f32(vcvtq_f32_u32(vaddq_u32(lead, lag)), vscale);
+            uint32x4_t xi = (k & 1) ? vmovl_u16(vget_high_u16(x16[k >> 1]))
+                                    : vmovl_u16(vget_low_u16(x16[k >> 1]));
+            mask[k] = vcgtq_f32(vcvtq_f32_u32(xi), noise);
+        }
+        uint8x16_t m = vcombine_u8(vmovn_u16(vcombine_u16(vmovn_u32(mask[0]), vmovn_u32(mask[1]))),
+                                   vmovn_u16(vcombine_u16(vmovn_u32(mask[2]), vmovn_u32(mask[3]))));
+        vst1q_u8(hits + i, vandq_u8(m, vcgeq_u8(x, floor)));
+    }
+#endif
+    for (; i < full_end; i++) {
+        hits[i] = row[i] >= m_noise_floor && (float)row[i] > (float)(
+            prefix[i - guard] - prefix[i - guard - window] +
+            prefix[i + guard + 1 + window] - prefix[i + guard + 1]) * scale ? 0xFF : 0;
+    }
+    for (; i < len; i++) {
+        hits[i] = edge(i);
+    }
+}
+
+void BlobDetector::ExtractRuns(uint32_t angle, const uint8_t* row, size_t len) {
+    const uint8_t* hits = m_hits.data();
+    size_t i = 0;
+    while (i < len) {
+        // Most of a spoke is empty: skip it 16 samples at a time
+#if defined(MAYARA_SSE2)
+        while (i + 16 <= len &&
+               _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(hits + i))) == 0) {
+            i += 16;
+        }
+#elif defined(MAYARA_NEON)
+        while (i + 16 <= len) {
+            uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8(hits + i));
+            if ((vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) != 0) break;
+            i += 16;
+        }
+#endif
+        if (i >= len) break;
+        if (!hits[i]) {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        uint32_t weight = 0;
+        uint64_t moment = 0;
+        uint8_t peak = 0;
+        for (; i < len && hits[i]; i++) {
+            weight += row[i];
+            moment += (uint64_t)row[i] * i;
+            peak = std::max(peak, row[i]);
+        }
+        m_run_angle.push_back(angle);
+        m_run_start.push_back((uint16_t)start);
+        m_run_end.push_back((uint16_t)i);
+        m_run_weight.push_back(weight);
+        m_run_moment.push_back(moment);
+        m_run_peak.push_back(peak);
+    }
+}
+
+void BlobDetector::JoinRuns(size_t a_first, size_t a_end, size_t b_first, size_t b_end) {
+    // Runs touch when they overlap in range or meet at a corner. Both
+    // lists are sorted, so runs of 'a' ending before 'b' starts are done.
+    size_t a = a_first;
+    for (size_t b = b_first; b < b_end; b++) {
+        while (a < a_end && m_run_end[a] < m_run_start[b]) a++;
+        for (size_t k = a; k < a_end && m_run_start[k] <= m_run_end[b]; k++) {
+            Union((uint32_t)k, (uint32_t)b);
+        }
+    }
+}
+
+uint32_t BlobDetector::Find(uint32_t run) {
+    while (m_parent[run] != run) {
+        m_parent[run] = m_parent[m_parent[run]];
+        run = m_parent[run];
+    }
+    return run;
+}
+
+void BlobDetector::Union(uint32_t a, uint32_t b) {
+    a = Find(a);
+    b = Find(b);
+    if (a < b) {
+        m_parent[b] = a;
+    } else if (b < a) {
+        m_parent[a] = b;
+    }
+}
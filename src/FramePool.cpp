@@ -0,0 +1,58 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Fixed set of reusable frame buffers
+ */
+
+#include "FramePool.h"
+#include <cstring>
+
+using namespace mayara;
+
+// Worst-case protobuf encoding of one Spoke besides its data: the spoke's
+// own tag and length, angle, bearing, range, time, lat, lon and the
+// data field's tag and length
+static const size_t SPOKE_OVERHEAD = 2 + 4 + 6 + 6 + 11 + 11 + 11 + 11 + 4;
+
+// RadarMessage.radar
+static const size_t MESSAGE_OVERHEAD = 6;
+
+FramePool::FramePool(size_t frames, size_t frame_capacity)
+    : m_frames(frames)
+    , m_free(frames)
+    , m_grown(0)
+{
+    for (Frame& frame : m_frames) {
+        frame.data.resize(frame_capacity);
+        frame.length = 0;
+        m_free.TryPush(&frame);
+    }
+}
+
+FramePool::~FramePool() {
+}
+
+Frame* FramePool::Acquire() {
+    return m_free.Pop();
+}
+
+void FramePool::Release(Frame* frame) {
+    if (frame) {
+        m_free.TryPush(frame);
+    }
+}
+
+void FramePool::Fill(Frame* frame, const uint8_t* data, size_t len) {
+    if (frame->data.size() < len) {
+        frame->data.resize(len);
+        m_grown.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::memcpy(frame->data.data(), data, len);
+    frame->length = len;
+}
+
+size_t FramePool::FrameCapacity(size_t spokes, size_t max_spoke_len) {
+    return MESSAGE_OVERHEAD + spokes * (SPOKE_OVERHEAD + max_spoke_len);
+}
@@ -0,0 +1,105 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Bounded lock-free queue of raw WebSocket frames
+ */
+
+#include "FrameQueue.h"
+
+using namespace mayara;
+
+FrameQueue::FrameQueue(size_t capacity)
+    : m_enqueue_pos(0)
+    , m_dequeue_pos(0)
+    , m_queued(0)
+    , m_dropped(0)
+{
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    m_mask = size - 1;
+
+    // Each cell's sequence says whose turn it is: == pos means free for
+    // the producer at pos, == pos + 1 means filled for the consumer at pos
+    m_cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; i++) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].frame = nullptr;
+    }
+}
+
+FrameQueue::~FrameQueue() {
+}
+
+bool FrameQueue::TryPush(Frame* frame) {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // Full
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->frame = frame;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+Frame* FrameQueue::Push(Frame* frame) {
+    Frame* dropped = nullptr;
+    while (!TryPush(frame)) {
+        // Full: drop the oldest frame to make room. With one producer the
+        // freed cell is ours on the next try; with several, another
+        // producer may win it and we wait for the consumer instead of
+        // dropping a second frame.
+        if (!dropped) {
+            dropped = Pop();
+            if (dropped) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    return dropped;
+}
+
+Frame* FrameQueue::Pop() {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return nullptr;  // Empty
+        } else {
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    Frame* frame = cell->frame;
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return frame;
+}
+
+bool FrameQueue::IsEmpty() const {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    size_t seq = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(pos + 1) < 0;
+}
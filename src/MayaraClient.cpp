@@ -175,6 +175,7 @@ std::map<std::string, RadarInfo> MayaraClient::GetRadars() {
         info.status = state.status;
         info.spokesPerRevolution = caps.spokesPerRevolution();
         info.maxSpokeLength = caps.maxSpokeLength();
+        info.pixelValues = caps.pixelValues();
         info.rangeMeters = state.rangeMeters;
 
         radars[id] = info;
@@ -307,6 +308,7 @@ CapabilityManifest MayaraClient::GetCapabilities(const std::string& radarId) {
     // Initialize characteristics with defaults
     caps.characteristics.spokesPerRevolution = 2048;
     caps.characteristics.maxSpokeLength = 512;
+    caps.characteristics.pixelValues = 0;
     caps.characteristics.maxRange = 96000;  // 96km
     caps.characteristics.minRange = 50;
     caps.characteristics.hasDoppler = false;
@@ -336,6 +338,7 @@ CapabilityManifest MayaraClient::GetCapabilities(const std::string& radarId) {
             caps.characteristics.minRange = ch.value("minRange", 50u);
             caps.characteristics.spokesPerRevolution = ch.value("spokesPerRevolution", 2048);
             caps.characteristics.maxSpokeLength = ch.value("maxSpokeLength", 512);
+            caps.characteristics.pixelValues = ch.value("pixelValues", 0);
             caps.characteristics.hasDoppler = ch.value("hasDoppler", false);
             caps.characteristics.hasDualRange = ch.value("hasDualRange", false);
             caps.characteristics.maxDualRange = ch.value("maxDualRange", 0u);
@@ -0,0 +1,75 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Own ship motion between position fixes
+ */
+
+#include "OwnShip.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mayara;
+
+static const double METERS_PER_DEGREE = 111320.0;
+
+// Dead reckoning from the last fix stops after this long
+static const double MAX_DEAD_RECKONING_MS = 60000.0;
+
+OwnShip::OwnShip()
+    : m_hdt(NAN)
+    , m_cog(NAN)
+    , m_sog(NAN)
+    , m_fix_time(0)
+{
+}
+
+void OwnShip::Set(const GeoPosition& position, double heading, double cog, double sog,
+                  int64_t now_ms) {
+    if (position.lat != m_fix.lat || position.lon != m_fix.lon) {
+        m_fix = position;
+        m_fix_time = now_ms;
+    }
+    m_hdt = heading;
+    m_cog = cog;
+    m_sog = sog;
+}
+
+double OwnShip::GetHeading() const {
+    return std::isfinite(m_hdt) ? m_hdt : (std::isfinite(m_cog) ? m_cog : 0.0);
+}
+
+void OwnShip::GetVelocity(double& east, double& north) const {
+    east = 0.0;
+    north = 0.0;
+    if (std::isfinite(m_sog) && std::isfinite(m_cog)) {
+        east = m_sog * KNOTS_TO_MPS * sin(DegToRad(m_cog));
+        north = m_sog * KNOTS_TO_MPS * cos(DegToRad(m_cog));
+    }
+}
+
+void OwnShip::GetPosition(const GeoPosition& anchor, int64_t now_ms,
+                          double& east, double& north) const {
+    Offset(anchor, m_fix, east, north);
+    if (m_fix_time == 0) return;
+
+    double elapsed = std::min((double)(now_ms - m_fix_time), MAX_DEAD_RECKONING_MS);
+    if (elapsed > 0.0) {
+        double vx, vy;
+        GetVelocity(vx, vy);
+        east += vx * elapsed / 1000.0;
+        north += vy * elapsed / 1000.0;
+    }
+}
+
+void OwnShip::Offset(const GeoPosition& anchor, const GeoPosition& position,
+                     double& east, double& north) {
+    north = (position.lat - anchor.lat) * METERS_PER_DEGREE;
+    east = (position.lon - anchor.lon) * METERS_PER_DEGREE * cos(DegToRad(anchor.lat));
+}
+
+GeoPosition OwnShip::Move(const GeoPosition& anchor, double east, double north) {
+    return GeoPosition(anchor.lat + north / METERS_PER_DEGREE,
+                       anchor.lon + east / (METERS_PER_DEGREE * cos(DegToRad(anchor.lat))));
+}
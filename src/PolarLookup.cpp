@@ -0,0 +1,57 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Precomputed cartesian to polar coordinate table for the radar disk
+ */
+
+#include "PolarLookup.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mayara;
+
+PolarLookup::PolarLookup()
+    : m_size(0)
+{
+}
+
+bool PolarLookup::Build(size_t size) {
+    if (size == m_size) return false;
+
+    m_size = size;
+    m_table.assign(size * size * 2, 0);
+
+    // Sample at texel centers, matching how the GPU samples the texture
+    // and the analytic path in the polar shaders
+    for (size_t y = 0; y < size; y++) {
+        double py = (y + 0.5) / size * 2.0 - 1.0;
+        uint16_t* row = &m_table[y * size * 2];
+
+        for (size_t x = 0; x < size; x++) {
+            double px = (x + 0.5) / size * 2.0 - 1.0;
+            double dist = sqrt(px * px + py * py);
+
+            if (dist >= 1.0) {
+                row[x * 2] = OUTSIDE;
+                row[x * 2 + 1] = 0;
+                continue;
+            }
+
+            // Clockwise from the bow (-y)
+            double angle = atan2(px, -py) / (2.0 * M_PI);
+            if (angle < 0.0) angle += 1.0;
+
+            row[x * 2] = (uint16_t)std::min(dist * 65535.0 + 0.5, 65534.0);
+            row[x * 2 + 1] = (uint16_t)(angle * 65535.0 + 0.5);
+        }
+    }
+
+    return true;
+}
+
+void PolarLookup::Release() {
+    m_size = 0;
+    std::vector<uint16_t>().swap(m_table);
+}
@@ -12,17 +12,24 @@
 #include <wx/spinctrl.h>
 #include <wx/url.h>
 #include <wx/sstream.h>
+#include <algorithm>
 
 using namespace mayara;
 
 enum {
-    ID_TEST_CONNECTION = wxID_HIGHEST + 100
+    ID_TEST_CONNECTION = wxID_HIGHEST + 100,
+    ID_INTEGRATION_REVOLUTIONS
 };
 
+// Trail length choices in seconds
+static const int s_trail_lengths[] = {15, 30, 60, 180, 360, 600, 1800};
+static const int s_trail_length_count = sizeof(s_trail_lengths) / sizeof(s_trail_lengths[0]);
+
 BEGIN_EVENT_TABLE(PreferencesDialog, wxDialog)
     EVT_BUTTON(wxID_OK, PreferencesDialog::OnOK)
     EVT_BUTTON(wxID_CANCEL, PreferencesDialog::OnCancel)
     EVT_BUTTON(ID_TEST_CONNECTION, PreferencesDialog::OnTestConnection)
+    EVT_SPINCTRL(ID_INTEGRATION_REVOLUTIONS, PreferencesDialog::OnIntegrationRevolutions)
 END_EVENT_TABLE()
 
 PreferencesDialog::PreferencesDialog(wxWindow* parent, mayara_server_pi* plugin)
@@ -118,6 +125,147 @@ void PreferencesDialog::CreateControls() {
 
     mainSizer->Add(displayBox, 0, wxEXPAND | wxALL, 10);
 
+    // Performance box
+    wxStaticBoxSizer* perfBox = new wxStaticBoxSizer(
+        wxVERTICAL, this, _("Performance"));
+
+    wxFlexGridSizer* perfGrid = new wxFlexGridSizer(2, 5, 5);
+    perfGrid->AddGrowableCol(1);
+
+    // Spoke decimation, index i merges 2^i spokes
+    wxArrayString factors;
+    factors.Add(_("Off"));
+    factors.Add(_("2 spokes"));
+    factors.Add(_("4 spokes"));
+    factors.Add(_("8 spokes"));
+    perfGrid->Add(new wxStaticText(this, wxID_ANY, _("Merge adjacent spokes:")),
+                  0, wxALIGN_CENTER_VERTICAL);
+    m_decimation_choice = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                       wxDefaultSize, factors);
+    perfGrid->Add(m_decimation_choice, 0);
+
+    // Order matches mayara::DecimationMode
+    wxArrayString modes;
+    modes.Add(_("Strongest echo"));
+    modes.Add(_("Average"));
+    modes.Add(_("Peak hold"));
+    perfGrid->Add(new wxStaticText(this, wxID_ANY, _("Merge mode:")),
+                  0, wxALIGN_CENTER_VERTICAL);
+    m_decimation_mode_choice = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                            wxDefaultSize, modes);
+    perfGrid->Add(m_decimation_mode_choice, 0);
+
+    // Scan-to-scan integration, order matches mayara::IntegrationMode
+    // after "Off"
+    wxArrayString integration;
+    integration.Add(_("Off"));
+    integration.Add(_("Minimum"));
+    integration.Add(_("Average"));
+    integration.Add(_("M of N"));
+    perfGrid->Add(new wxStaticText(this, wxID_ANY, _("Scan-to-scan filter:")),
+                  0, wxALIGN_CENTER_VERTICAL);
+    m_integration_choice = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                        wxDefaultSize, integration);
+    perfGrid->Add(m_integration_choice, 0);
+
+    perfGrid->Add(new wxStaticText(this, wxID_ANY, _("Revolutions (N):")),
+                  0, wxALIGN_CENTER_VERTICAL);
+    m_integration_revolutions_ctrl = new wxSpinCtrl(this, ID_INTEGRATION_REVOLUTIONS, wxEmptyString,
+                                                    wxDefaultPosition, wxDefaultSize,
+                                                    wxSP_ARROW_KEYS, 2, 8);
+    perfGrid->Add(m_integration_revolutions_ctrl, 0);
+
+    // M can't exceed N, see OnIntegrationRevolutions
+    perfGrid->Add(new wxStaticText(this, wxID_ANY, _("Hits required (M):")),
+                  0, wxALIGN_CENTER_VERTICAL);
+    m_integration_required_ctrl = new wxSpinCtrl(this, wxID_ANY, wxEmptyString,
+                                                 wxDefaultPosition, wxDefaultSize,
+                                                 wxSP_ARROW_KEYS, 1, 8);
+    perfGrid->Add(m_integration_required_ctrl, 0);
+
+    perfBox->Add(perfGrid, 1, wxEXPAND | wxALL, 5);
+    mainSizer->Add(perfBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
+    // Afterglow box
+    wxStaticBoxSizer* afterglowBox = new wxStaticBoxSizer(
+        wxVERTICAL, this, _("Afterglow"));
+
+    wxFlexGridSizer* afterglowGrid = new wxFlexGridSizer(2, 5, 5);
+    afterglowGrid->AddGrowableCol(1);
+
+    // Echoes fade to about a third after one time constant
+    afterglowGrid->Add(new wxStaticText(this, wxID_ANY, _("Fade time constant (sec, 0 = off):")),
+                       0, wxALIGN_CENTER_VERTICAL);
+    m_afterglow_ctrl = new wxSpinCtrlDouble(this, wxID_ANY, wxEmptyString,
+                                            wxDefaultPosition, wxDefaultSize,
+                                            wxSP_ARROW_KEYS, 0.0, 120.0, 0.0, 0.5);
+    afterglowGrid->Add(m_afterglow_ctrl, 0);
+
+    afterglowBox->Add(afterglowGrid, 1, wxEXPAND | wxALL, 5);
+    mainSizer->Add(afterglowBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
+    // Trails box
+    wxStaticBoxSizer* trailBox = new wxStaticBoxSizer(
+        wxVERTICAL, this, _("Trails"));
+
+    wxFlexGridSizer* trailGrid = new wxFlexGridSizer(2, 5, 5);
+    trailGrid->AddGrowableCol(1);
+
+    // Order matches mayara::TrailMode
+    wxArrayString trailModes;
+    trailModes.Add(_("Off"));
+    trailModes.Add(_("Relative motion"));
+    trailModes.Add(_("True motion"));
+    trailGrid->Add(new wxStaticText(this, wxID_ANY, _("Trails:")),
+                   0, wxALIGN_CENTER_VERTICAL);
+    m_trail_mode_choice = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                       wxDefaultSize, trailModes);
+    trailGrid->Add(m_trail_mode_choice, 0);
+
+    // Order matches s_trail_lengths
+    wxArrayString trailLengths;
+    trailLengths.Add(_("15 seconds"));
+    trailLengths.Add(_("30 seconds"));
+    trailLengths.Add(_("1 minute"));
+    trailLengths.Add(_("3 minutes"));
+    trailLengths.Add(_("6 minutes"));
+    trailLengths.Add(_("10 minutes"));
+    trailLengths.Add(_("30 minutes"));
+    trailGrid->Add(new wxStaticText(this, wxID_ANY, _("Trail length:")),
+                   0, wxALIGN_CENTER_VERTICAL);
+    m_trail_length_choice = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                         wxDefaultSize, trailLengths);
+    trailGrid->Add(m_trail_length_choice, 0);
+
+    trailBox->Add(trailGrid, 1, wxEXPAND | wxALL, 5);
+    mainSizer->Add(trailBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
+    // Target detection box
+    wxStaticBoxSizer* detectionBox = new wxStaticBoxSizer(
+        wxVERTICAL, this, _("Target Detection"));
+
+    m_detection_checkbox = new wxCheckBox(this, wxID_ANY,
+                                          _("Detect targets locally"));
+    detectionBox->Add(m_detection_checkbox, 0, wxALL, 5);
+
+    m_auto_acquire_checkbox = new wxCheckBox(this, wxID_ANY,
+                                             _("Track all detected targets"));
+    detectionBox->Add(m_auto_acquire_checkbox, 0, wxALL, 5);
+
+    wxFlexGridSizer* detectionGrid = new wxFlexGridSizer(2, 5, 5);
+    detectionGrid->AddGrowableCol(1);
+
+    // Echoes this many times stronger than their surroundings are targets
+    detectionGrid->Add(new wxStaticText(this, wxID_ANY, _("Threshold over background:")),
+                       0, wxALIGN_CENTER_VERTICAL);
+    m_detection_threshold_ctrl = new wxSpinCtrlDouble(this, wxID_ANY, wxEmptyString,
+                                                      wxDefaultPosition, wxDefaultSize,
+                                                      wxSP_ARROW_KEYS, 1.5, 20.0, 3.0, 0.5);
+    detectionGrid->Add(m_detection_threshold_ctrl, 0);
+
+    detectionBox->Add(detectionGrid, 1, wxEXPAND | wxALL, 5);
+    mainSizer->Add(detectionBox, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
     // Buttons
     wxStdDialogButtonSizer* btnSizer = new wxStdDialogButtonSizer();
     btnSizer->AddButton(new wxButton(this, wxID_OK));
@@ -136,6 +284,29 @@ void PreferencesDialog::LoadSettings() {
     m_reconnect_interval_ctrl->SetValue(m_plugin->GetReconnectInterval());
     m_overlay_checkbox->SetValue(m_plugin->GetShowOverlay());
     m_ppi_checkbox->SetValue(m_plugin->GetShowPPIWindow());
+
+    int index = 0;
+    while (index < 3 && (1 << (index + 1)) <= m_plugin->GetSpokeDecimation()) index++;
+    m_decimation_choice->SetSelection(index);
+    m_decimation_mode_choice->SetSelection(
+        std::min(std::max(m_plugin->GetDecimationMode(), 0), 2));
+    m_integration_choice->SetSelection(std::min(std::max(m_plugin->GetIntegrationMode(), 0), 3));
+    m_integration_revolutions_ctrl->SetValue(m_plugin->GetIntegrationRevolutions());
+    m_integration_required_ctrl->SetRange(1, m_integration_revolutions_ctrl->GetValue());
+    m_integration_required_ctrl->SetValue(m_plugin->GetIntegrationRequired());
+    m_afterglow_ctrl->SetValue(m_plugin->GetAfterglow());
+
+    m_trail_mode_choice->SetSelection(std::min(std::max(m_plugin->GetTrailMode(), 0), 2));
+    int length = 0;
+    while (length < s_trail_length_count - 1 &&
+           s_trail_lengths[length] < m_plugin->GetTrailLength()) {
+        length++;
+    }
+    m_trail_length_choice->SetSelection(length);
+
+    m_detection_checkbox->SetValue(m_plugin->GetLocalDetection());
+    m_detection_threshold_ctrl->SetValue(m_plugin->GetDetectionThreshold());
+    m_auto_acquire_checkbox->SetValue(m_plugin->GetAutoAcquire());
 }
 
 void PreferencesDialog::SaveSettings() {
@@ -145,6 +316,17 @@ void PreferencesDialog::SaveSettings() {
     m_plugin->SetReconnectInterval(m_reconnect_interval_ctrl->GetValue());
     m_plugin->SetShowOverlay(m_overlay_checkbox->GetValue());
     m_plugin->SetShowPPIWindow(m_ppi_checkbox->GetValue());
+    m_plugin->SetSpokeDecimation(1 << m_decimation_choice->GetSelection());
+    m_plugin->SetDecimationMode(m_decimation_mode_choice->GetSelection());
+    m_plugin->SetIntegrationMode(m_integration_choice->GetSelection());
+    m_plugin->SetIntegrationRevolutions(m_integration_revolutions_ctrl->GetValue());
+    m_plugin->SetIntegrationRequired(m_integration_required_ctrl->GetValue());
+    m_plugin->SetAfterglow(m_afterglow_ctrl->GetValue());
+    m_plugin->SetTrailMode(m_trail_mode_choice->GetSelection());
+    m_plugin->SetTrailLength(s_trail_lengths[m_trail_length_choice->GetSelection()]);
+    m_plugin->SetLocalDetection(m_detection_checkbox->GetValue());
+    m_plugin->SetDetectionThreshold(m_detection_threshold_ctrl->GetValue());
+    m_plugin->SetAutoAcquire(m_auto_acquire_checkbox->GetValue());
 }
 
 void PreferencesDialog::OnOK(wxCommandEvent& event) {
@@ -156,6 +338,14 @@ void PreferencesDialog::OnCancel(wxCommandEvent& event) {
     EndModal(wxID_CANCEL);
 }
 
+void PreferencesDialog::OnIntegrationRevolutions(wxSpinEvent& event) {
+    int revolutions = event.GetPosition();
+    m_integration_required_ctrl->SetRange(1, revolutions);
+    if (m_integration_required_ctrl->GetValue() > revolutions) {
+        m_integration_required_ctrl->SetValue(revolutions);
+    }
+}
+
 void PreferencesDialog::OnTestConnection(wxCommandEvent& event) {
     wxString host = m_host_ctrl->GetValue();
     int port = m_port_ctrl->GetValue();
@@ -12,6 +12,7 @@
 #include "RadarDisplay.h"
 #include "RadarPPIRenderer.h"
 #include "SpokeBuffer.h"
+#include <algorithm>
 
 using namespace mayara;
 
@@ -23,11 +24,16 @@ static int gl_attribs[] = {
     0
 };
 
+// Pixels from a target within which a click selects it
+static const float TARGET_HIT_RADIUS = 12.0f;
+
 BEGIN_EVENT_TABLE(RadarCanvas, wxGLCanvas)
     EVT_PAINT(RadarCanvas::OnPaint)
     EVT_SIZE(RadarCanvas::OnSize)
     EVT_MOUSEWHEEL(RadarCanvas::OnMouseWheel)
     EVT_LEFT_DOWN(RadarCanvas::OnLeftDown)
+    EVT_LEFT_UP(RadarCanvas::OnLeftUp)
+    EVT_MOTION(RadarCanvas::OnMotion)
     EVT_RIGHT_DOWN(RadarCanvas::OnRightDown)
     EVT_KEY_DOWN(RadarCanvas::OnKeyDown)
 END_EVENT_TABLE()
@@ -41,9 +47,13 @@ RadarCanvas::RadarCanvas(wxWindow* parent,
     , m_radar(radar)
     , m_context(nullptr)
     , m_zoom(1.0)
+    , m_pan_x(0.0f)
+    , m_pan_y(0.0f)
     , m_dragging(false)
+    , m_drag_moved(false)
     , m_drag_start_x(0)
     , m_drag_start_y(0)
+    , m_selected_target(-1)
 {
     m_context = new wxGLContext(this);
 }
@@ -73,15 +83,29 @@ void RadarCanvas::OnPaint(wxPaintEvent& event) {
     // Update and render
     auto* renderer = m_radar->GetPPIRenderer();
     if (renderer) {
+        renderer->SetUsePBO(m_plugin->GetPBOUpload());
+        renderer->SetUsePolarLookup(m_plugin->GetPolarLookup());
+        renderer->SetAfterglow(m_plugin->GetAfterglow());
+        renderer->SetView(m_zoom, m_pan_x, m_pan_y);
+        renderer->SetSelectedTarget(m_selected_target);
         renderer->UpdateTexture(m_radar->GetSpokeBuffer());
+
+        TrailBuffer* trails = m_radar->GetTrailBuffer();
+        trails->SetMode((TrailMode)std::min(std::max(m_plugin->GetTrailMode(), 0), 2));
+        trails->SetOwnShip(m_plugin->GetOwnPosition(), m_plugin->GetHeading(),
+                           m_plugin->GetCog(), m_plugin->GetSog());
+        trails->Update(m_radar->GetSpokeBuffer());
+        renderer->SetTrailLength(m_plugin->GetTrailLength());
+        renderer->UpdateTrails(trails);
         renderer->DrawPPI(m_context, width, height,
-                          m_radar->GetRangeMeters(),
+                          m_radar->GetImageRangeMeters(),
                           m_plugin->GetHeading());
 
         // Draw targets
         renderer->DrawTargets(width, height,
-                              m_radar->GetRangeMeters(),
-                              m_radar->GetTargets());
+                              m_radar->GetImageRangeMeters(),
+                              m_plugin->GetHeading(),
+                              *m_radar->GetTargets());
     }
 
     SwapBuffers();
@@ -109,11 +133,59 @@ void RadarCanvas::OnMouseWheel(wxMouseEvent& event) {
 }
 
 void RadarCanvas::OnLeftDown(wxMouseEvent& event) {
-    // Acquire target at click position
+    // Start a pan; a click without movement acquires a target on release
+    m_dragging = true;
+    m_drag_moved = false;
+    m_drag_start_x = event.GetX();
+    m_drag_start_y = event.GetY();
+    if (!HasCapture()) CaptureMouse();
+}
+
+void RadarCanvas::OnMotion(wxMouseEvent& event) {
+    if (!m_dragging || !event.LeftIsDown()) return;
+
+    int dx = event.GetX() - m_drag_start_x;
+    int dy = event.GetY() - m_drag_start_y;
+
+    // Ignore small jitter so clicks still acquire targets
+    if (!m_drag_moved && abs(dx) < 3 && abs(dy) < 3) return;
+    m_drag_moved = true;
+
+    m_pan_x += dx;
+    m_pan_y += dy;
+    m_drag_start_x = event.GetX();
+    m_drag_start_y = event.GetY();
+
+    Refresh(false);
+}
+
+void RadarCanvas::OnLeftUp(wxMouseEvent& event) {
+    if (HasCapture()) ReleaseMouse();
+    if (!m_dragging) return;
+    m_dragging = false;
+    if (m_drag_moved) return;
+
     if (!m_radar) return;
 
+    // A click on a drawn target selects it, or clears the selection
+    auto* renderer = m_radar->GetPPIRenderer();
+    if (renderer) {
+        int target_id = renderer->HitTestTarget(event.GetX(), event.GetY(), TARGET_HIT_RADIUS);
+        if (target_id >= 0) {
+            m_selected_target = target_id == m_selected_target ? -1 : target_id;
+            Refresh(false);
+            return;
+        }
+    }
+
+    // Acquire target at click position
     double bearing, distance;
     if (MouseToRadar(event.GetX(), event.GetY(), bearing, distance)) {
+        // The local tracker only queues the request for its next sweep
+        if (TargetTracker* tracker = m_radar->GetTracker()) {
+            tracker->Acquire(bearing, distance);
+            return;
+        }
         auto* manager = m_plugin->GetRadarManager();
         if (manager && manager->GetClient()) {
             manager->GetClient()->AcquireTarget(m_radar->GetId(), bearing, distance);
@@ -139,6 +211,8 @@ void RadarCanvas::OnKeyDown(wxKeyEvent& event) {
             break;
         case '0':
             m_zoom = 1.0;
+            m_pan_x = 0.0f;
+            m_pan_y = 0.0f;
             break;
         default:
             event.Skip();
@@ -166,11 +240,13 @@ bool RadarCanvas::MouseToRadar(int x, int y, double& bearing, double& distance)
     int width, height;
     GetClientSize(&width, &height);
 
-    // Calculate center and radius
-    int display_size = std::min(width, height) - 40;
-    float radius = display_size / 2.0f;
-    float cx = width / 2.0f;
-    float cy = height / 2.0f;
+    // Center and radius as drawn, including zoom and pan
+    auto* renderer = m_radar->GetPPIRenderer();
+    if (!renderer) return false;
+
+    float cx, cy, radius;
+    renderer->SetView(m_zoom, m_pan_x, m_pan_y);
+    renderer->GetDisplayGeometry(width, height, cx, cy, radius);
 
     // Convert to relative coordinates
     float dx = x - cx;
@@ -187,13 +263,14 @@ bool RadarCanvas::MouseToRadar(int x, int y, double& bearing, double& distance)
     bearing = angle * 180.0 / M_PI;
     if (bearing < 0) bearing += 360.0;
 
-    // Adjust for heading
+    // The image is turned by -heading (see RadarPPIRenderer::DrawPPI), so
+    // this undoes it and gives the bearing of the spoke under the mouse
     bearing += m_plugin->GetHeading();
     while (bearing >= 360.0) bearing -= 360.0;
     while (bearing < 0) bearing += 360.0;
 
     // Calculate distance
-    distance = dist_ratio * m_radar->GetRangeMeters();
+    distance = dist_ratio * m_radar->GetImageRangeMeters();
 
     return true;
 }
@@ -12,6 +12,7 @@
 #include "RadarOverlayRenderer.h"
 #include "RadarPPIRenderer.h"
 #include "RadarCanvas.h"
+#include <algorithm>
 
 using namespace mayara;
 
@@ -25,11 +26,83 @@ RadarDisplay::RadarDisplay(mayara_server_pi* plugin,
     , m_range_meters(info.rangeMeters)
     , m_spokes_per_revolution(info.spokesPerRevolution > 0 ? info.spokesPerRevolution : 2048)
     , m_max_spoke_length(info.maxSpokeLength > 0 ? info.maxSpokeLength : 512)
+    , m_detected_revolutions(0)
     , m_ppi_window(nullptr)
 {
+    // Merging adjacent spokes shrinks everything downstream, so the
+    // buffer and textures are sized for the decimated spoke count.
+    // The factor must divide the spoke count; 8 keeps Mean sums in 16 bits.
+    int factor = plugin->GetSpokeDecimation();
+    if (factor > 1 && factor <= 8 && (factor & (factor - 1)) == 0 &&
+        m_spokes_per_revolution % factor == 0) {
+        m_decimator = std::make_unique<SpokeDecimator>(
+            m_spokes_per_revolution,
+            factor,
+            m_max_spoke_length,
+            (DecimationMode)std::min(std::max(plugin->GetDecimationMode(), 0), 2)
+        );
+        wxLogMessage("MaYaRa: Merging %d spokes into one (%d -> %d)",
+                     factor, m_spokes_per_revolution, m_spokes_per_revolution / factor);
+    } else if (factor > 1) {
+        wxLogMessage("MaYaRa: Spoke decimation %d not possible with %d spokes",
+                     factor, m_spokes_per_revolution);
+    }
+
+    // Radars with at most 16 intensity levels are stored two samples per
+    // byte, halving buffer memory and texture uploads
+    bool packed = info.pixelValues > 0 && info.pixelValues <= 16;
+    if (packed) {
+        wxLogMessage("MaYaRa: %d intensity levels, storing spokes packed", info.pixelValues);
+    }
+
+    size_t spokes = m_decimator ? m_decimator->GetOutputSpokes() : m_spokes_per_revolution;
+
+    // Echoes in the upper half of the intensity levels count as hits for
+    // M-of-N integration and leave trails
+    uint8_t threshold = info.pixelValues > 1 ? std::min(info.pixelValues / 2, 255) : 128;
+
+    // Scan-to-scan integration works on the decimated spokes
+    int integration = plugin->GetIntegrationMode();
+    if (integration >= 1 && integration <= 3) {
+        m_integrator = std::make_unique<ScanIntegrator>(
+            spokes,
+            m_max_spoke_length,
+            plugin->GetIntegrationRevolutions(),
+            (IntegrationMode)(integration - 1)
+        );
+        m_integrator->SetRequired(plugin->GetIntegrationRequired());
+        m_integrator->SetThreshold(threshold);
+        wxLogMessage("MaYaRa: Integrating %d revolutions", (int)m_integrator->GetRevolutions());
+    }
+
     // Create spoke buffer (no OpenGL needed)
     m_spoke_buffer = std::make_unique<SpokeBuffer>(
-        m_spokes_per_revolution,
+        spokes,
+        m_max_spoke_length,
+        packed
+    );
+
+    m_trail_buffer = std::make_unique<TrailBuffer>();
+    m_trail_buffer->SetThreshold(threshold);
+
+    // Local detection runs on every complete revolution, so the buffer
+    // has to assemble them
+    if (plugin->GetLocalDetection()) {
+        m_detector = std::make_unique<BlobDetector>();
+        m_detector->SetFactor((float)plugin->GetDetectionThreshold());
+        m_detector->SetNoiseFloor(std::max<uint8_t>(threshold / 4, 1));
+        m_detector->SetMinRange(m_max_spoke_length / 50);
+        m_spoke_buffer->SetSweepsEnabled(true);
+        m_tracker = std::make_unique<TargetTracker>();
+        m_tracker->SetAutoAcquire(plugin->GetAutoAcquire());
+        wxLogMessage("MaYaRa: Detecting targets locally");
+    }
+
+    // Everything after the socket runs on this radar's ingest worker
+    m_ingest = std::make_unique<SpokeIngest>(
+        [this](const SpokeData* spokes, size_t count) {
+            OnSpokeBatch(spokes, count);
+        },
         m_max_spoke_length
     );
 
@@ -71,13 +144,16 @@ void RadarDisplay::Start() {
         wxLogMessage("MaYaRa: RadarDisplay::Start() - URL: %s", url.c_str());
         wxLog::FlushActive();
 
-        // Create receiver with callback
+        // Start the worker before frames can arrive
+        m_ingest->Start();
+
+        // Create receiver, it only queues raw frames for the worker
         wxLogMessage("MaYaRa: RadarDisplay::Start() - creating SpokeReceiver");
         wxLog::FlushActive();
         m_receiver = std::make_unique<SpokeReceiver>(
             url,
-            [this](const SpokeData& spoke) {
-                OnSpokeReceived(spoke);
+            [this](const uint8_t* data, size_t len) {
+                m_ingest->Submit(data, len);
             }
         );
         wxLogMessage("MaYaRa: RadarDisplay::Start() - SpokeReceiver created");
@@ -86,6 +162,13 @@ void RadarDisplay::Start() {
         wxLogMessage("MaYaRa: RadarDisplay::Start() - calling m_receiver->Start()");
         wxLog::FlushActive();
         m_receiver->Start();
+
+        // Server targets arrive as a stream of changes
+        m_target_receiver = std::make_unique<TargetReceiver>(
+            manager->GetClient()->GetTargetStreamUrl(m_id),
+            &m_target_table
+        );
+        m_target_receiver->Start();
         wxLogMessage("MaYaRa: RadarDisplay::Start() - complete");
         wxLog::FlushActive();
     } catch (const std::exception& e) {
@@ -102,6 +185,13 @@ void RadarDisplay::Stop() {
         m_receiver->Stop();
         m_receiver.reset();
     }
+    if (m_target_receiver) {
+        m_target_receiver->Stop();
+        m_target_receiver.reset();
+    }
+    if (m_ingest) {
+        m_ingest->Stop();
+    }
 }
 
 void RadarDisplay::UpdateCapabilities(const CapabilityManifest& caps) {
@@ -128,23 +218,54 @@ void RadarDisplay::UpdateState(const RadarState& state) {
     m_range_meters = state.rangeMeters;
 }
 
+double RadarDisplay::GetImageRangeMeters() const {
+    uint32_t grid_range = m_spoke_buffer ? m_spoke_buffer->GetGridRange() : 0;
+    return grid_range != 0 ? grid_range : m_range_meters;
+}
+
 bool RadarDisplay::IsReceiving() const {
     return m_receiver && m_receiver->IsConnected();
 }
 
+std::shared_ptr<const std::vector<ArpaTarget>> RadarDisplay::GetTargets() const {
+    if (m_tracker) return m_tracker->GetTargets();
+    return m_target_table.GetTargets();
+}
+
 void RadarDisplay::UpdateTargets(const std::vector<ArpaTarget>& targets) {
-    wxCriticalSectionLocker lock(m_lock);
-    m_targets = targets;
+    m_target_table.Assign(targets);
+    m_target_table.Publish();
 }
 
-void RadarDisplay::OnSpokeReceived(const SpokeData& spoke) {
+void RadarDisplay::OnSpokeBatch(const SpokeData* spokes, size_t count) {
     if (!m_spoke_buffer) return;
 
-    // Write spoke to buffer
-    m_spoke_buffer->WriteSpoke(
-        spoke.angle,
-        spoke.data.data(),
-        spoke.data.size(),
-        spoke.rangeMeters
-    );
+    if (m_decimator) {
+        m_decimator->Process(spokes, count, m_decimated);
+        spokes = m_decimated.data();
+        count = m_decimated.size();
+        if (count == 0) return;
+    }
+
+    if (m_integrator) {
+        m_integrator->Process(spokes, count, m_integrated);
+        spokes = m_integrated.data();
+        count = m_integrated.size();
+    }
+
+    // Queue the whole frame for the render thread, never blocks
+    m_spoke_buffer->WriteSpokes(spokes, count);
+
+    // Detect once per revolution, when this frame completed one. Takes a
+    // few ms per revolution, which the frame queue absorbs.
+    if (m_detector && m_spoke_buffer->GetRevolutions() != m_detected_revolutions) {
+        m_detected_revolutions = m_spoke_buffer->GetRevolutions();
+        std::shared_ptr<const Sweep> sweep = m_spoke_buffer->GetLastSweep();
+        if (sweep) {
+            auto blobs = std::make_shared<BlobList>();
+            m_detector->Detect(*sweep, *blobs);
+            m_tracker->Update(*blobs);
+            std::atomic_store(&m_blobs, std::shared_ptr<const BlobList>(blobs));
+        }
+    }
 }
@@ -0,0 +1,155 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Allocation-free decoder for the RadarMessage protobuf (proto/RadarMessage.proto)
+ */
+
+#include "RadarMessageReader.h"
+
+using namespace mayara;
+
+// Protobuf wire types
+enum {
+    WIRE_VARINT = 0,
+    WIRE_FIXED64 = 1,
+    WIRE_LENGTH_DELIMITED = 2,
+    WIRE_FIXED32 = 5
+};
+
+// Read a base-128 varint, advancing p. Returns false on truncation or
+// if the varint is longer than 10 bytes.
+static inline bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    // Fast path: single byte, which covers tags and small fields
+    if (p < end && *p < 0x80) {
+        value = *p++;
+        return true;
+    }
+
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Skip a field we don't care about. Groups (wire types 3/4) are not
+// used by proto3 and are treated as malformed input.
+static inline bool SkipField(const uint8_t*& p, const uint8_t* end, uint32_t wire_type) {
+    uint64_t len;
+    switch (wire_type) {
+        case WIRE_VARINT:
+            return ReadVarint(p, end, len);
+        case WIRE_FIXED64:
+            if (end - p < 8) return false;
+            p += 8;
+            return true;
+        case WIRE_LENGTH_DELIMITED:
+            if (!ReadVarint(p, end, len) || len > (uint64_t)(end - p)) return false;
+            p += len;
+            return true;
+        case WIRE_FIXED32:
+            if (end - p < 4) return false;
+            p += 4;
+            return true;
+        default:
+            return false;
+    }
+}
+
+RadarMessageReader::RadarMessageReader(const uint8_t* data, size_t len)
+    : m_pos(data)
+    , m_end(data + len)
+    , m_radar(0)
+    , m_error(false)
+{
+}
+
+bool RadarMessageReader::Next(SpokeData& spoke) {
+    while (m_pos < m_end && !m_error) {
+        uint64_t tag;
+        if (!ReadVarint(m_pos, m_end, tag)) {
+            m_error = true;
+            break;
+        }
+
+        uint32_t field = (uint32_t)(tag >> 3);
+        uint32_t wire_type = (uint32_t)(tag & 7);
+
+        if (field == 1 && wire_type == WIRE_VARINT) {
+            // radar
+            uint64_t value;
+            if (!ReadVarint(m_pos, m_end, value)) {
+                m_error = true;
+                break;
+            }
+            m_radar = (uint32_t)value;
+        } else if (field == 2 && wire_type == WIRE_LENGTH_DELIMITED) {
+            // repeated Spoke spokes
+            uint64_t len;
+            if (!ReadVarint(m_pos, m_end, len) || len > (uint64_t)(m_end - m_pos)) {
+                m_error = true;
+                break;
+            }
+            const uint8_t* spoke_begin = m_pos;
+            m_pos += len;
+            if (!DecodeSpoke(spoke_begin, m_pos, spoke)) {
+                m_error = true;
+                break;
+            }
+            return true;
+        } else if (!SkipField(m_pos, m_end, wire_type)) {
+            m_error = true;
+            break;
+        }
+    }
+    return false;
+}
+
+bool RadarMessageReader::DecodeSpoke(const uint8_t* p, const uint8_t* end, SpokeData& spoke) {
+    spoke.angle = 0;
+    spoke.bearing = 0;
+    spoke.hasBearing = false;
+    spoke.rangeMeters = 0;
+    spoke.timestamp = 0;
+    spoke.lat = 0;
+    spoke.lon = 0;
+    spoke.data = nullptr;
+    spoke.length = 0;
+
+    while (p < end) {
+        uint64_t tag;
+        if (!ReadVarint(p, end, tag)) return false;
+
+        uint32_t field = (uint32_t)(tag >> 3);
+        uint32_t wire_type = (uint32_t)(tag & 7);
+        uint64_t value;
+
+        if (wire_type == WIRE_VARINT && field >= 1 && field <= 7 && field != 5) {
+            if (!ReadVarint(p, end, value)) return false;
+            switch (field) {
+                case 1: spoke.angle = (uint32_t)value; break;
+                case 2: spoke.bearing = (uint32_t)value; spoke.hasBearing = true; break;
+                case 3: spoke.rangeMeters = (uint32_t)value; break;
+                case 4: spoke.timestamp = value; break;
+                case 6: spoke.lat = (int64_t)value; break;
+                case 7: spoke.lon = (int64_t)value; break;
+            }
+        } else if (field == 5 && wire_type == WIRE_LENGTH_DELIMITED) {
+            if (!ReadVarint(p, end, value) || value > (uint64_t)(end - p)) return false;
+            spoke.data = p;
+            spoke.length = (size_t)value;
+            p += value;
+        } else if (!SkipField(p, end, wire_type)) {
+            return false;
+        }
+    }
+
+    return true;
+}
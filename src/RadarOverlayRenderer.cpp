@@ -13,33 +13,57 @@
 
 #include "RadarOverlayRenderer.h"
 #include "SpokeBuffer.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace mayara;
 
 RadarOverlayRenderer::RadarOverlayRenderer()
     : RadarRenderer()
+    , m_loc_position(-1)
     , m_loc_center(-1)
     , m_loc_scale(-1)
     , m_loc_rotation(-1)
     , m_loc_texture(-1)
     , m_loc_palette(-1)
+    , m_dc_x(0)
+    , m_dc_y(0)
 {
 }
 
 RadarOverlayRenderer::~RadarOverlayRenderer() {
 }
 
-bool RadarOverlayRenderer::Init(size_t spokes, size_t maxSpokeLen) {
-    if (!RadarRenderer::Init(spokes, maxSpokeLen)) {
+bool RadarOverlayRenderer::Init(size_t spokes, size_t maxSpokeLen, bool packed) {
+    if (!RadarRenderer::Init(spokes, maxSpokeLen, packed)) {
         return false;
     }
 
-    // TODO: Compile shaders
-    // For now, use simple immediate mode rendering
+    // Without shaders DrawOverlay falls back to the CPU rasterizer
+    if (!CompileShaders()) {
+        wxLogMessage("MaYaRa: Overlay shaders unavailable, using fallback");
+    }
 
     return true;
 }
 
+bool RadarOverlayRenderer::CompileShaders() {
+    if (!InitGLFunctions()) return false;
+
+    m_vertex_shader = CompileShader(GL_VERTEX_SHADER, GetVertexShaderSource());
+    m_fragment_shader = CompileFragmentShader(GetFragmentShaderSource());
+    if (!LinkProgram()) return false;
+
+    m_loc_position = glGetAttribLocation(m_program, "position");
+    m_loc_center = glGetUniformLocation(m_program, "center");
+    m_loc_scale = glGetUniformLocation(m_program, "scale");
+    m_loc_rotation = glGetUniformLocation(m_program, "rotation");
+    m_loc_texture = glGetUniformLocation(m_program, "radar_texture");
+    m_loc_palette = glGetUniformLocation(m_program, "palette");
+
+    return m_loc_position >= 0;
+}
+
 void RadarOverlayRenderer::DrawOverlay(wxGLContext* context,
                                         PlugIn_ViewPort* vp,
                                         double range_meters,
@@ -48,6 +72,127 @@ void RadarOverlayRenderer::DrawOverlay(wxGLContext* context,
 {
     if (!m_initialized || !vp) return;
 
+    float cx, cy, radius, rotation;
+    GetScreenGeometry(vp, range_meters, radar_pos, heading, cx, cy, radius, rotation);
+
+    // Save OpenGL state
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+
+    // Enable blending for transparency
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Trails under the echoes
+    DrawTrails(cx, cy, radius, rotation);
+
+    if (UseRasterizer()) {
+        DrawRasterQuad(cx, cy, radius, rotation);
+    } else {
+        DrawPolarQuad(cx, cy, radius, rotation);
+    }
+
+    // Restore OpenGL state
+    glPopAttrib();
+}
+
+void RadarOverlayRenderer::DrawOverlayDC(wxDC& dc,
+                                          PlugIn_ViewPort* vp,
+                                          double range_meters,
+                                          const GeoPosition& radar_pos,
+                                          double heading,
+                                          SpokeBuffer* buffer)
+{
+    if (!vp || !buffer) return;
+
+    float cx, cy, radius, rotation;
+    GetScreenGeometry(vp, range_meters, radar_pos, heading, cx, cy, radius, rotation);
+    if (!std::isfinite(radius) || radius < 1.0f) return;
+
+    // Only the part of the disk inside the viewport is drawn, so the
+    // bitmap never outgrows the canvas however far the chart is zoomed in
+    double left = std::max((double)cx - radius, 0.0);
+    double top = std::max((double)cy - radius, 0.0);
+    double right = std::min((double)cx + radius, (double)vp->pix_width);
+    double bottom = std::min((double)cy + radius, (double)vp->pix_height);
+    if (right - left < 1.0 || bottom - top < 1.0) return;
+
+    // One bitmap pixel per screen pixel up to a cap, very large disks are
+    // scaled up. The DC can't rotate bitmaps, so the rasterizer bakes the
+    // rotation in.
+    m_rasterizer.SetSize((size_t)std::min(ceil(2.0 * radius), 2048.0));
+    m_rasterizer.SetRotation(rotation);
+
+    // No GL UpdateTexture() in this mode, so pull the spokes here
+    buffer->Drain();
+
+    bool changed = m_rasterizer.Update(buffer);
+    size_t size = m_rasterizer.GetSize();
+
+    // Rasterizer pixel shown at the center of each visible screen column
+    // and row, nearest neighbour
+    int x0 = (int)floor(left), y0 = (int)floor(top);
+    int width = (int)ceil(right) - x0, height = (int)ceil(bottom) - y0;
+    double scale = size / (2.0 * radius);
+    auto map = [&](std::vector<uint32_t>& out, int first, int count, double origin) {
+        out.resize(count);
+        for (int i = 0; i < count; i++) {
+            double v = (first + i + 0.5 - origin) * scale;
+            out[i] = (uint32_t)std::min(std::max(v, 0.0), size - 1.0);
+        }
+    };
+    map(m_dc_map_x, x0, width, (double)cx - radius);
+    map(m_dc_map_y, y0, height, (double)cy - radius);
+
+    // Keep the converted image between frames and only refresh the rows
+    // showing bitmap rows the swept wedge touched
+    size_t first = 0, count = 0;
+    bool full = !m_dc_image.IsOk() || x0 != m_dc_x || y0 != m_dc_y ||
+                m_dc_map_x != m_dc_shown_x || m_dc_map_y != m_dc_shown_y;
+    if (full) {
+        m_dc_image = wxImage(width, height, false);
+        m_dc_image.InitAlpha();
+        m_dc_x = x0;
+        m_dc_y = y0;
+        m_dc_shown_x = m_dc_map_x;
+        m_dc_shown_y = m_dc_map_y;
+        count = size;
+    } else if (changed) {
+        m_rasterizer.GetDirtyRows(first, count);
+    }
+
+    if (count > 0) {
+        const uint32_t* pixels = (const uint32_t*)m_rasterizer.GetPixels();
+        unsigned char* rgb = m_dc_image.GetData();
+        unsigned char* alpha = m_dc_image.GetAlpha();
+        for (int y = 0; y < height; y++) {
+            uint32_t sy = m_dc_map_y[y];
+            if (sy < first || sy >= first + count) continue;
+            const uint8_t* src = (const uint8_t*)(pixels + (size_t)sy * size);
+            unsigned char* row_rgb = rgb + (size_t)y * width * 3;
+            unsigned char* row_alpha = alpha + (size_t)y * width;
+            for (int x = 0; x < width; x++) {
+                const uint8_t* p = src + m_dc_map_x[x] * 4;
+                row_rgb[x * 3] = p[0];
+                row_rgb[x * 3 + 1] = p[1];
+                row_rgb[x * 3 + 2] = p[2];
+                row_alpha[x] = p[3];
+            }
+        }
+        m_dc_bitmap = wxBitmap(m_dc_image);
+    }
+
+    if (m_dc_bitmap.IsOk()) {
+        dc.DrawBitmap(m_dc_bitmap, m_dc_x, m_dc_y, true);
+    }
+}
+
+void RadarOverlayRenderer::GetScreenGeometry(PlugIn_ViewPort* vp,
+                                             double range_meters,
+                                             const GeoPosition& radar_pos,
+                                             double heading,
+                                             float& cx, float& cy,
+                                             float& radius, float& rotation)
+{
     // Get screen position of radar
     wxPoint radar_screen;
     GetCanvasPixLL(vp, &radar_screen, radar_pos.lat, radar_pos.lon);
@@ -59,56 +204,45 @@ void RadarOverlayRenderer::DrawOverlay(wxGLContext* context,
     GetCanvasPixLL(vp, &range_point, radar_pos.lat + lat_offset, radar_pos.lon);
 
     double pixels_per_meter = fabs(range_point.y - radar_screen.y) / range_meters;
-    double radius_pixels = range_meters * pixels_per_meter;
 
-    // Save OpenGL state
-    glPushMatrix();
-    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    cx = radar_screen.x;
+    cy = radar_screen.y;
+    radius = range_meters * pixels_per_meter;
 
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Translate to radar center
-    glTranslatef(radar_screen.x, radar_screen.y, 0);
-
-    // Rotate for heading (OpenCPN uses north-up, we need to apply heading)
-    glRotatef(-heading, 0, 0, 1);
-
-    // Draw radar as a simple colored circle for now
-    // TODO: Replace with shader-based polar texture rendering
+    // Rotate the spoke image so the bow points along the heading, taking
+    // a rotated chart (course-up etc.) into account
+    rotation = DegToRad(heading) + vp->rotation;
+}
 
-    glBindTexture(GL_TEXTURE_2D, m_texture);
-    glEnable(GL_TEXTURE_2D);
+void RadarOverlayRenderer::DrawPolarQuad(float cx, float cy, float radius, float rotation) {
+    if (IsUsingPolarLookup() && DrawLookupQuad(cx, cy, radius, rotation)) {
+        return;
+    }
 
-    // Draw as a textured quad that will be transformed
-    // This is a placeholder - real implementation uses polar shader
-    int segments = 360;
-    glBegin(GL_TRIANGLE_FAN);
-    glColor4f(0, 1, 0, 0.5f);  // Semi-transparent green center
-    glVertex2f(0, 0);
+    // One quad covering the radar disk, the fragment shader looks up
+    // the spoke and range for every pixel
+    glUseProgram(m_program);
+    BindRadarTextures();
 
-    for (int i = 0; i <= segments; i++) {
-        float angle = (float)i * 2.0f * M_PI / segments;
-        float x = cos(angle) * radius_pixels;
-        float y = sin(angle) * radius_pixels;
-        glColor4f(0, 0.5f, 0, 0.3f);  // Fade at edges
-        glVertex2f(x, y);
-    }
-    glEnd();
+    glUniform1i(m_loc_texture, 0);
+    glUniform1i(m_loc_palette, 1);
+    glUniform2f(m_loc_center, cx, cy);
+    glUniform1f(m_loc_scale, radius);
+    glUniform1f(m_loc_rotation, rotation);
+    SetAfterglowUniforms(m_loc_age_texture, m_loc_afterglow);
 
-    glDisable(GL_TEXTURE_2D);
+    DrawUnitQuad(m_loc_position);
 
-    // Restore OpenGL state
-    glPopAttrib();
-    glPopMatrix();
+    glUseProgram(0);
 }
 
 const char* RadarOverlayRenderer::GetVertexShaderSource() {
+    // position is the unit quad; center and scale are in screen pixels
+    // (y down), rotation turns the bow clockwise from screen-up
     return R"(
         #version 120
         attribute vec2 position;
-        varying vec2 v_texcoord;
+        varying vec2 v_pos;
         uniform vec2 center;
         uniform float scale;
         uniform float rotation;
@@ -116,38 +250,36 @@ const char* RadarOverlayRenderer::GetVertexShaderSource() {
         void main() {
             float c = cos(rotation);
             float s = sin(rotation);
-            mat2 rot = mat2(c, -s, s, c);
-            vec2 pos = rot * position * scale + center;
-            gl_Position = vec4(pos, 0.0, 1.0);
-            v_texcoord = position * 0.5 + 0.5;
+            vec2 p = vec2(position.x * c - position.y * s,
+                          position.x * s + position.y * c);
+            gl_Position = gl_ModelViewProjectionMatrix *
+                          vec4(center + p * scale, 0.0, 1.0);
+            v_pos = position;
         }
     )";
 }
 
 const char* RadarOverlayRenderer::GetFragmentShaderSource() {
+    // Compiled with CompileFragmentShader(), which supplies SampleSpoke()
     return R"(
-        #version 120
-        varying vec2 v_texcoord;
-        uniform sampler2D radar_texture;
+        varying vec2 v_pos;
         uniform sampler1D palette;
 
         void main() {
-            // Convert cartesian to polar
-            vec2 pos = v_texcoord * 2.0 - 1.0;
-            float angle = atan(pos.y, pos.x);
-            float dist = length(pos);
-
+            // Convert cartesian to polar, bow is -y in the quad
+            float dist = length(v_pos);
             if (dist > 1.0) discard;
+            float angle = atan(v_pos.x, -v_pos.y);
 
-            // Map angle to texture coordinate (0-1)
-            float u = (angle + 3.14159) / (2.0 * 3.14159);
-            float v = dist;
+            // Texture rows are spokes (clockwise from bow), columns range
+            float u = fract(angle / 6.28318531);
+            float intensity = SampleSpoke(vec2(dist, u));
 
-            // Sample radar data
-            float intensity = texture2D(radar_texture, vec2(v, u)).r;
+            // Map through palette, centered on the 256 palette texels
+            gl_FragColor = texture1D(palette, (intensity * 255.0 + 0.5) / 256.0);
 
-            // Map through palette
-            gl_FragColor = texture1D(palette, intensity);
+            // Fade old echoes towards the chart
+            gl_FragColor.a *= SpokeAfterglow(u);
         }
     )";
 }
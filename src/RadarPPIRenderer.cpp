@@ -13,33 +13,141 @@
 
 #include "RadarPPIRenderer.h"
 #include "SpokeBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
 
 using namespace mayara;
 
 RadarPPIRenderer::RadarPPIRenderer()
     : RadarRenderer()
+    , m_loc_position(-1)
     , m_loc_center(-1)
     , m_loc_radius(-1)
     , m_loc_rotation(-1)
     , m_loc_texture(-1)
     , m_loc_palette(-1)
+    , m_target_program(0)
+    , m_target_vertex_shader(0)
+    , m_target_fragment_shader(0)
+    , m_target_vbo(0)
+    , m_target_loc_position(-1)
+    , m_target_loc_offset(-1)
+    , m_target_loc_course(-1)
+    , m_target_loc_color(-1)
+    , m_zoom(1.0)
+    , m_pan_x(0.0f)
+    , m_pan_y(0.0f)
     , m_show_range_rings(true)
     , m_show_heading_line(true)
     , m_show_targets(true)
+    , m_selected_target(-1)
 {
 }
 
 RadarPPIRenderer::~RadarPPIRenderer() {
+    DeleteTargetResources();
 }
 
-bool RadarPPIRenderer::Init(size_t spokes, size_t maxSpokeLen) {
-    if (!RadarRenderer::Init(spokes, maxSpokeLen)) {
+bool RadarPPIRenderer::Init(size_t spokes, size_t maxSpokeLen, bool packed) {
+    if (!RadarRenderer::Init(spokes, maxSpokeLen, packed)) {
         return false;
     }
 
+    if (!CompileShaders()) {
+        wxLogMessage("MaYaRa: PPI shaders unavailable, using fallback");
+    }
+    if (!CompileTargetShaders()) {
+        wxLogMessage("MaYaRa: Target shaders unavailable, turning symbols on the CPU");
+    }
+
+    // Target geometry is respecified every frame
+    if (HaveGLBufferFunctions()) {
+        glGenBuffers(1, &m_target_vbo);
+    }
+
+    return true;
+}
+
+void RadarPPIRenderer::Reset() {
+    DeleteTargetResources();
+    RadarRenderer::Reset();
+}
+
+void RadarPPIRenderer::DeleteTargetResources() {
+    if (m_target_vbo) {
+        glDeleteBuffers(1, &m_target_vbo);
+        m_target_vbo = 0;
+    }
+    if (m_target_program) {
+        glDeleteProgram(m_target_program);
+        m_target_program = 0;
+    }
+    if (m_target_vertex_shader) {
+        glDeleteShader(m_target_vertex_shader);
+        m_target_vertex_shader = 0;
+    }
+    if (m_target_fragment_shader) {
+        glDeleteShader(m_target_fragment_shader);
+        m_target_fragment_shader = 0;
+    }
+}
+
+bool RadarPPIRenderer::CompileShaders() {
+    if (!InitGLFunctions()) return false;
+
+    m_vertex_shader = CompileShader(GL_VERTEX_SHADER, GetVertexShaderSource());
+    m_fragment_shader = CompileFragmentShader(GetFragmentShaderSource());
+    if (!LinkProgram()) return false;
+
+    m_loc_position = glGetAttribLocation(m_program, "position");
+    m_loc_center = glGetUniformLocation(m_program, "center");
+    m_loc_radius = glGetUniformLocation(m_program, "radius");
+    m_loc_rotation = glGetUniformLocation(m_program, "rotation");
+    m_loc_texture = glGetUniformLocation(m_program, "radar_texture");
+    m_loc_palette = glGetUniformLocation(m_program, "palette");
+
+    return m_loc_position >= 0;
+}
+
+bool RadarPPIRenderer::CompileTargetShaders() {
+    if (!InitGLFunctions()) return false;
+
+    m_target_vertex_shader = CompileShader(GL_VERTEX_SHADER, GetTargetVertexShaderSource());
+    m_target_fragment_shader = CompileShader(GL_FRAGMENT_SHADER, GetTargetFragmentShaderSource());
+    m_target_program = LinkProgram(m_target_vertex_shader, m_target_fragment_shader);
+    if (!m_target_program) return false;
+
+    m_target_loc_position = glGetAttribLocation(m_target_program, "position");
+    m_target_loc_offset = glGetAttribLocation(m_target_program, "offset");
+    m_target_loc_course = glGetAttribLocation(m_target_program, "course");
+    m_target_loc_color = glGetAttribLocation(m_target_program, "color");
+    if (m_target_loc_position < 0 || m_target_loc_offset < 0 ||
+        m_target_loc_course < 0 || m_target_loc_color < 0) {
+        glDeleteProgram(m_target_program);
+        m_target_program = 0;
+        return false;
+    }
     return true;
 }
 
+void RadarPPIRenderer::SetView(double zoom, float pan_x, float pan_y) {
+    m_zoom = zoom;
+    m_pan_x = pan_x;
+    m_pan_y = pan_y;
+}
+
+void RadarPPIRenderer::GetDisplayGeometry(int width, int height,
+                                          float& cx, float& cy, float& radius) const {
+    // Fit to window with margin, then apply zoom and pan
+    int margin = 20;
+    int display_size = std::min(width, height) - 2 * margin;
+    radius = display_size / 2.0f * m_zoom;
+    cx = width / 2.0f + m_pan_x;
+    cy = height / 2.0f + m_pan_y;
+}
+
 void RadarPPIRenderer::DrawPPI(wxGLContext* context,
                                 int width, int height,
                                 double range_meters,
@@ -47,12 +155,8 @@ void RadarPPIRenderer::DrawPPI(wxGLContext* context,
 {
     if (!m_initialized) return;
 
-    // Calculate display radius (fit to window with margin)
-    int margin = 20;
-    int display_size = std::min(width, height) - 2 * margin;
-    float radius = display_size / 2.0f;
-    float cx = width / 2.0f;
-    float cy = height / 2.0f;
+    float cx, cy, radius;
+    GetDisplayGeometry(width, height, cx, cy, radius);
 
     // Set up orthographic projection
     glMatrixMode(GL_PROJECTION);
@@ -72,36 +176,29 @@ void RadarPPIRenderer::DrawPPI(wxGLContext* context,
     glColor4f(0.1f, 0.1f, 0.15f, 1.0f);
     DrawCircle(cx, cy, radius, 64);
 
-    // Draw radar texture
-    glBindTexture(GL_TEXTURE_2D, m_texture);
-    glEnable(GL_TEXTURE_2D);
-
-    // Draw as polar sectors
-    // This is a simplified version - production would use shaders
-    int segments = m_spokes;
-    float angle_step = 2.0f * M_PI / segments;
-
-    glBegin(GL_TRIANGLES);
-    for (int i = 0; i < segments; i++) {
-        float angle1 = i * angle_step - heading * M_PI / 180.0f - M_PI / 2.0f;
-        float angle2 = (i + 1) * angle_step - heading * M_PI / 180.0f - M_PI / 2.0f;
-
-        // Center vertex
-        glTexCoord2f(0, (float)i / segments);
-        glColor4f(0, 0.5f, 0, 0.5f);
-        glVertex2f(cx, cy);
-
-        // Edge vertices
-        glTexCoord2f(1, (float)i / segments);
-        glColor4f(0, 0.8f, 0, 0.3f);
-        glVertex2f(cx + cos(angle1) * radius, cy + sin(angle1) * radius);
-
-        glTexCoord2f(1, (float)(i + 1) / segments);
-        glVertex2f(cx + cos(angle2) * radius, cy + sin(angle2) * radius);
+    // Draw radar texture as a single quad; zoom, pan and heading are all
+    // uniforms so changing the view costs no geometry work
+    float rotation = -DegToRad(heading);
+    DrawTrails(cx, cy, radius, rotation);
+    if (IsUsingPolarLookup() && DrawLookupQuad(cx, cy, radius, rotation)) {
+        // Angle and range came from the precomputed lookup texture
+    } else if (HasShaders()) {
+        glUseProgram(m_program);
+        BindRadarTextures();
+
+        glUniform1i(m_loc_texture, 0);
+        glUniform1i(m_loc_palette, 1);
+        glUniform2f(m_loc_center, cx, cy);
+        glUniform1f(m_loc_radius, radius);
+        glUniform1f(m_loc_rotation, rotation);
+        SetAfterglowUniforms(m_loc_age_texture, m_loc_afterglow);
+
+        DrawUnitQuad(m_loc_position);
+
+        glUseProgram(0);
+    } else {
+        DrawRasterQuad(cx, cy, radius, rotation);
     }
-    glEnd();
-
-    glDisable(GL_TEXTURE_2D);
 
     // Draw overlays
     if (m_show_range_rings) {
@@ -120,10 +217,8 @@ void RadarPPIRenderer::DrawPPI(wxGLContext* context,
 }
 
 void RadarPPIRenderer::DrawRangeRings(int width, int height, double range_meters, int num_rings) {
-    int display_size = std::min(width, height) - 40;
-    float radius = display_size / 2.0f;
-    float cx = width / 2.0f;
-    float cy = height / 2.0f;
+    float cx, cy, radius;
+    GetDisplayGeometry(width, height, cx, cy, radius);
 
     glColor4f(0.5f, 0.5f, 0.5f, 0.7f);
     glLineWidth(1.0f);
@@ -141,10 +236,8 @@ void RadarPPIRenderer::DrawRangeRings(int width, int height, double range_meters
 }
 
 void RadarPPIRenderer::DrawHeadingLine(int width, int height, double heading) {
-    int display_size = std::min(width, height) - 40;
-    float radius = display_size / 2.0f;
-    float cx = width / 2.0f;
-    float cy = height / 2.0f;
+    float cx, cy, radius;
+    GetDisplayGeometry(width, height, cx, cy, radius);
 
     float angle = -heading * M_PI / 180.0f - M_PI / 2.0f;
 
@@ -157,41 +250,239 @@ void RadarPPIRenderer::DrawHeadingLine(int width, int height, double heading) {
     glEnd();
 }
 
+// Track number labels, drawn as seven segment digits
+static const float DIGIT_WIDTH = 5.0f;
+static const float DIGIT_HEIGHT = 8.0f;
+static const float DIGIT_SPACING = 2.0f;
+static const float LABEL_GAP = 10.0f;
+static const float TARGET_SYMBOL = 8.0f;
+static const int SELECTION_SEGMENTS = 24;
+
+static const uint8_t TARGET_COLOR[4] = { 255, 0, 0, 255 };
+static const uint8_t SELECTED_COLOR[4] = { 255, 255, 0, 255 };
+static const uint8_t LABEL_COLOR[4] = { 230, 230, 230, 255 };
+
 void RadarPPIRenderer::DrawTargets(int width, int height, double range_meters,
-                                    const std::vector<ArpaTarget>& targets)
+                                    double heading, const std::vector<ArpaTarget>& targets)
 {
-    int display_size = std::min(width, height) - 40;
-    float radius = display_size / 2.0f;
-    float cx = width / 2.0f;
-    float cy = height / 2.0f;
+    float cx, cy, radius;
+    GetDisplayGeometry(width, height, cx, cy, radius);
+
+    // The image holds bearings relative to the bow and is turned by
+    // -heading, so a true bearing is made relative (-heading) and then
+    // turned like the image (-heading again)
+    float rotation = -2.0f * DegToRad(heading);
+
+    m_target_x.clear();
+    m_target_y.clear();
+    m_target_ids.clear();
+    m_target_distance.clear();
+    m_symbol_vertices.clear();
+    m_line_vertices.clear();
+
+    // Without a range nothing can be placed; hit tests find nothing
+    if (!(range_meters > 0.0)) {
+        m_target_index.Build(nullptr, nullptr, 0, 1.0f);
+        return;
+    }
 
+    int max_id = 0;
     for (const auto& target : targets) {
         // Convert bearing/distance to screen coordinates
-        float bearing_rad = target.bearing * M_PI / 180.0f - M_PI / 2.0f;
+        float bearing_rad = target.bearing * M_PI / 180.0f + rotation - M_PI / 2.0f;
         float dist_ratio = target.distance / range_meters;
         if (dist_ratio > 1.0f) continue;  // Out of range
 
         float tx = cx + cos(bearing_rad) * radius * dist_ratio;
         float ty = cy + sin(bearing_rad) * radius * dist_ratio;
+        if (!std::isfinite(tx) || !std::isfinite(ty)) continue;
+
+        m_target_x.push_back(tx);
+        m_target_y.push_back(ty);
+        m_target_ids.push_back(target.targetId);
+        m_target_distance.push_back(target.distance);
+        max_id = std::max(max_id, target.targetId);
+
+        // Symbol: triangle pointing along the course
+        float course = target.course * M_PI / 180.0f + rotation;
+        AddTargetVertex(m_symbol_vertices, tx, ty, 0, -TARGET_SYMBOL, course, TARGET_COLOR);
+        AddTargetVertex(m_symbol_vertices, tx, ty, -TARGET_SYMBOL * 0.6f, TARGET_SYMBOL * 0.5f,
+                        course, TARGET_COLOR);
+        AddTargetVertex(m_symbol_vertices, tx, ty, TARGET_SYMBOL * 0.6f, TARGET_SYMBOL * 0.5f,
+                        course, TARGET_COLOR);
+
+        // Velocity vector
+        if (target.speed > 0.1) {
+            float length = target.speed * 5;  // Scale for visibility
+            AddTargetVertex(m_line_vertices, tx, ty, 0, 0, course, TARGET_COLOR);
+            AddTargetVertex(m_line_vertices, tx, ty, 0, -length, course, TARGET_COLOR);
+        }
+
+        if (target.targetId == m_selected_target) {
+            for (int i = 0; i < SELECTION_SEGMENTS; i++) {
+                for (int j = i; j <= i + 1; j++) {
+                    float angle = j * 2.0f * M_PI / SELECTION_SEGMENTS;
+                    AddTargetVertex(m_line_vertices, tx, ty,
+                                    cos(angle) * 2 * TARGET_SYMBOL, sin(angle) * 2 * TARGET_SYMBOL,
+                                    0, SELECTED_COLOR);
+                }
+            }
+        }
+    }
 
-        // Draw target symbol
-        glColor4f(1.0f, 0.0f, 0.0f, 1.0f);
-        DrawTriangle(tx, ty, 8, target.course * M_PI / 180.0f);
+    // Index the drawn positions for hit testing and label placement; cells
+    // about a label wide keep both to a few cells per query
+    int digits = 1;
+    for (int id = max_id; id >= 10; id /= 10) digits++;
+    float label_width = digits * (DIGIT_WIDTH + DIGIT_SPACING) - DIGIT_SPACING;
+    m_target_index.Build(m_target_x.data(), m_target_y.data(), m_target_x.size(),
+                         std::max(label_width + LABEL_GAP, 2 * TARGET_SYMBOL));
+
+    // The selected target gets its label first, then the nearest ones
+    m_label_order.resize(m_target_ids.size());
+    for (uint32_t i = 0; i < m_label_order.size(); i++) m_label_order[i] = i;
+    std::sort(m_label_order.begin(), m_label_order.end(), [this](uint32_t a, uint32_t b) {
+        bool selected_a = m_target_ids[a] == m_selected_target;
+        bool selected_b = m_target_ids[b] == m_selected_target;
+        if (selected_a != selected_b) return selected_a;
+        return m_target_distance[a] < m_target_distance[b];
+    });
+    m_target_index.PlaceLabels(m_label_order, label_width, DIGIT_HEIGHT, LABEL_GAP,
+                               TARGET_SYMBOL, m_label_left, m_label_top, m_label_shown);
+
+    for (size_t i = 0; i < m_target_ids.size(); i++) {
+        if (!m_label_shown[i]) continue;
+        AddNumber(m_label_left[i], m_label_top[i], m_target_ids[i],
+                  m_target_ids[i] == m_selected_target ? SELECTED_COLOR : LABEL_COLOR);
+    }
 
-        // Draw velocity vector
-        if (target.speed > 0.1) {
-            float course_rad = target.course * M_PI / 180.0f - M_PI / 2.0f;
-            float vx = tx + cos(course_rad) * target.speed * 5;  // Scale for visibility
-            float vy = ty + sin(course_rad) * target.speed * 5;
-
-            glBegin(GL_LINES);
-            glVertex2f(tx, ty);
-            glVertex2f(vx, vy);
-            glEnd();
+    // Same window pixel projection as the PPI
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, width, height, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glLineWidth(1.0f);
+    DrawTargetVertices(m_symbol_vertices, GL_TRIANGLES);
+    DrawTargetVertices(m_line_vertices, GL_LINES);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+int RadarPPIRenderer::HitTestTarget(float x, float y, float max_distance) const {
+    int i = m_target_index.Nearest(x, y, max_distance);
+    return i < 0 ? -1 : m_target_ids[i];
+}
+
+void RadarPPIRenderer::AddTargetVertex(std::vector<TargetVertex>& vertices,
+                                       float x, float y, float offset_x, float offset_y,
+                                       float course, const uint8_t* color) {
+    TargetVertex vertex;
+    vertex.x = x;
+    vertex.y = y;
+    vertex.offset_x = offset_x;
+    vertex.offset_y = offset_y;
+    vertex.course = course;
+    std::copy(color, color + 4, vertex.color);
+    vertices.push_back(vertex);
+}
+
+void RadarPPIRenderer::AddNumber(float x, float y, int number, const uint8_t* color) {
+    // Segments a to g: top, upper right, lower right, bottom, lower left,
+    // upper left, middle
+    static const uint8_t digit_segments[10] = {
+        0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+    };
+    static const float segment_lines[7][4] = {
+        { 0, 0, 1, 0 }, { 1, 0, 1, 0.5f }, { 1, 0.5f, 1, 1 }, { 0, 1, 1, 1 },
+        { 0, 0.5f, 0, 1 }, { 0, 0, 0, 0.5f }, { 0, 0.5f, 1, 0.5f }
+    };
+
+    char text[16];
+    int length = snprintf(text, sizeof(text), "%d", std::max(number, 0));
+
+    for (int i = 0; i < length; i++) {
+        uint8_t segments = digit_segments[text[i] - '0'];
+        float left = x + i * (DIGIT_WIDTH + DIGIT_SPACING);
+        for (int s = 0; s < 7; s++) {
+            if (!(segments & (1 << s))) continue;
+            const float* line = segment_lines[s];
+            AddTargetVertex(m_line_vertices, left, y,
+                            line[0] * DIGIT_WIDTH, line[1] * DIGIT_HEIGHT, 0, color);
+            AddTargetVertex(m_line_vertices, left, y,
+                            line[2] * DIGIT_WIDTH, line[3] * DIGIT_HEIGHT, 0, color);
         }
     }
 }
 
+void RadarPPIRenderer::DrawTargetVertices(const std::vector<TargetVertex>& vertices,
+                                          GLenum mode) {
+    if (vertices.empty()) return;
+
+    if (!m_target_program) {
+        // Fixed function: turn the offsets here, still one draw call
+        m_turned_vertices.resize(vertices.size() * 2);
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const TargetVertex& v = vertices[i];
+            float c = cos(v.course);
+            float s = sin(v.course);
+            m_turned_vertices[2 * i] = v.x + v.offset_x * c - v.offset_y * s;
+            m_turned_vertices[2 * i + 1] = v.y + v.offset_x * s + v.offset_y * c;
+        }
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, m_turned_vertices.data());
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TargetVertex), vertices[0].color);
+        glDrawArrays(mode, 0, (GLsizei)vertices.size());
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        return;
+    }
+
+    glUseProgram(m_target_program);
+
+    // Respecifying the whole buffer lets the driver hand out fresh storage
+    // instead of waiting for the previous frame's draw
+    const char* base = (const char*)vertices.data();
+    if (m_target_vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_target_vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TargetVertex),
+                     vertices.data(), GL_STREAM_DRAW);
+        base = nullptr;
+    }
+
+    const GLsizei stride = sizeof(TargetVertex);
+    glEnableVertexAttribArray(m_target_loc_position);
+    glEnableVertexAttribArray(m_target_loc_offset);
+    glEnableVertexAttribArray(m_target_loc_course);
+    glEnableVertexAttribArray(m_target_loc_color);
+    glVertexAttribPointer(m_target_loc_position, 2, GL_FLOAT, GL_FALSE, stride,
+                          base + offsetof(TargetVertex, x));
+    glVertexAttribPointer(m_target_loc_offset, 2, GL_FLOAT, GL_FALSE, stride,
+                          base + offsetof(TargetVertex, offset_x));
+    glVertexAttribPointer(m_target_loc_course, 1, GL_FLOAT, GL_FALSE, stride,
+                          base + offsetof(TargetVertex, course));
+    glVertexAttribPointer(m_target_loc_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                          base + offsetof(TargetVertex, color));
+
+    glDrawArrays(mode, 0, (GLsizei)vertices.size());
+
+    glDisableVertexAttribArray(m_target_loc_color);
+    glDisableVertexAttribArray(m_target_loc_course);
+    glDisableVertexAttribArray(m_target_loc_offset);
+    glDisableVertexAttribArray(m_target_loc_position);
+    if (m_target_vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glUseProgram(0);
+}
+
 void RadarPPIRenderer::DrawCircle(float cx, float cy, float radius, int segments) {
     glBegin(GL_TRIANGLE_FAN);
     glVertex2f(cx, cy);
@@ -209,56 +500,78 @@ void RadarPPIRenderer::DrawLine(float x1, float y1, float x2, float y2) {
     glEnd();
 }
 
-void RadarPPIRenderer::DrawTriangle(float x, float y, float size, float rotation) {
-    float c = cos(rotation);
-    float s = sin(rotation);
-
-    // Triangle pointing in direction of rotation
-    float p1x = 0, p1y = -size;
-    float p2x = -size * 0.6f, p2y = size * 0.5f;
-    float p3x = size * 0.6f, p3y = size * 0.5f;
-
-    // Rotate
-    glBegin(GL_TRIANGLES);
-    glVertex2f(x + p1x * c - p1y * s, y + p1x * s + p1y * c);
-    glVertex2f(x + p2x * c - p2y * s, y + p2x * s + p2y * c);
-    glVertex2f(x + p3x * c - p3y * s, y + p3x * s + p3y * c);
-    glEnd();
-}
-
 const char* RadarPPIRenderer::GetVertexShaderSource() {
+    // position is the unit quad; center and radius are in window pixels
+    // (y down), rotation turns the bow clockwise from screen-up
     return R"(
         #version 120
         attribute vec2 position;
-        varying vec2 v_texcoord;
+        varying vec2 v_pos;
+        uniform vec2 center;
+        uniform float radius;
+        uniform float rotation;
 
         void main() {
-            gl_Position = vec4(position, 0.0, 1.0);
-            v_texcoord = position * 0.5 + 0.5;
+            float c = cos(rotation);
+            float s = sin(rotation);
+            vec2 p = vec2(position.x * c - position.y * s,
+                          position.x * s + position.y * c);
+            gl_Position = gl_ModelViewProjectionMatrix *
+                          vec4(center + p * radius, 0.0, 1.0);
+            v_pos = position;
         }
     )";
 }
 
 const char* RadarPPIRenderer::GetFragmentShaderSource() {
+    // Compiled with CompileFragmentShader(), which supplies SampleSpoke()
     return R"(
-        #version 120
-        varying vec2 v_texcoord;
-        uniform sampler2D radar_texture;
+        varying vec2 v_pos;
         uniform sampler1D palette;
-        uniform float rotation;
 
         void main() {
-            vec2 pos = v_texcoord * 2.0 - 1.0;
-            float angle = atan(pos.y, pos.x) + rotation;
-            float dist = length(pos);
-
+            // Convert cartesian to polar, bow is -y in the quad
+            float dist = length(v_pos);
             if (dist > 1.0) discard;
+            float angle = atan(v_pos.x, -v_pos.y);
 
-            float u = mod(angle + 3.14159, 2.0 * 3.14159) / (2.0 * 3.14159);
-            float v = dist;
+            float u = fract(angle / 6.28318531);
+            float intensity = SampleSpoke(vec2(dist, u));
+            gl_FragColor = texture1D(palette, (intensity * 255.0 + 0.5) / 256.0);
+            gl_FragColor.a *= SpokeAfterglow(u);
+        }
+    )";
+}
 
-            float intensity = texture2D(radar_texture, vec2(v, u)).r;
-            gl_FragColor = texture1D(palette, intensity);
+const char* RadarPPIRenderer::GetTargetVertexShaderSource() {
+    // position is the target in window pixels, offset the vertex relative
+    // to it, turned clockwise from screen-up by course
+    return R"(
+        #version 120
+        attribute vec2 position;
+        attribute vec2 offset;
+        attribute float course;
+        attribute vec4 color;
+        varying vec4 v_color;
+
+        void main() {
+            float c = cos(course);
+            float s = sin(course);
+            vec2 p = position + vec2(offset.x * c - offset.y * s,
+                                     offset.x * s + offset.y * c);
+            gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);
+            v_color = color;
+        }
+    )";
+}
+
+const char* RadarPPIRenderer::GetTargetFragmentShaderSource() {
+    return R"(
+        #version 120
+        varying vec4 v_color;
+
+        void main() {
+            gl_FragColor = v_color;
         }
     )";
 }
@@ -0,0 +1,360 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * CPU scan converter from polar spokes to an RGBA bitmap
+ */
+
+#include "RadarRasterizer.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace mayara;
+
+RadarRasterizer::RadarRasterizer()
+    : m_size(0)
+    , m_spokes(0)
+    , m_spoke_len(0)
+    , m_table_size(0)
+    , m_row_bytes(0)
+    , m_pack_shift(0)
+    , m_sample_mask(0xFF)
+    , m_rotation(0.0)
+    , m_shift(0)
+    , m_applied_shift(0)
+    , m_sequence(0)
+    , m_full(true)
+    , m_last_pixel_count(0)
+    , m_dirty_row_first(0)
+    , m_dirty_row_end(0)
+{
+    SetColorPalette(ColorPalette());
+}
+
+RadarRasterizer::~RadarRasterizer() {
+}
+
+void RadarRasterizer::SetSize(size_t size) {
+    if (size == m_size) return;
+    m_size = size;
+    m_full = true;
+}
+
+void RadarRasterizer::SetRotation(double rotation) {
+    m_rotation = rotation;
+    if (m_spokes > 0) {
+        double turns = rotation / (2.0 * M_PI);
+        turns -= floor(turns);
+        m_shift = (uint32_t)lround(turns * m_spokes) % m_spokes;
+    }
+}
+
+void RadarRasterizer::SetColorPalette(const ColorPalette& palette) {
+    // LUT entries are RGBA bytes, which is also the pixel memory layout
+    std::memcpy(m_lut, palette.GetLUT(), sizeof(m_lut));
+    m_full = true;
+}
+
+void RadarRasterizer::BuildTables(size_t spokes, size_t spoke_len) {
+    m_spokes = spokes;
+    m_spoke_len = spoke_len;
+    m_table_size = m_size;
+    SetRotation(m_rotation);
+
+    m_lookup.Build(m_size);
+    m_pixels.assign(m_size * m_size, 0);
+
+    // Counting sort of the disk pixels by angle bucket
+    m_bucket_start.assign(spokes + 1, 0);
+    m_bucket_row_min.assign(spokes, 0xFFFF);
+    m_bucket_row_max.assign(spokes, 0);
+    for (size_t y = 0; y < m_size; y++) {
+        for (size_t x = 0; x < m_size; x++) {
+            if (m_lookup.GetRange(x, y) == PolarLookup::OUTSIDE) continue;
+            uint32_t bucket = (uint32_t)((uint64_t)m_lookup.GetAngle(x, y) * spokes / 65536);
+            m_bucket_start[bucket + 1]++;
+            m_bucket_row_min[bucket] = std::min<uint16_t>(m_bucket_row_min[bucket], y);
+            m_bucket_row_max[bucket] = std::max<uint16_t>(m_bucket_row_max[bucket], y);
+        }
+    }
+    for (size_t b = 0; b < spokes; b++) {
+        m_bucket_start[b + 1] += m_bucket_start[b];
+    }
+
+    size_t count = m_bucket_start[spokes];
+    m_pixel_range.resize(count);
+    m_pixel_index.resize(count);
+
+    m_span_bucket.resize(count);
+    m_span_range.resize(count);
+    m_span_x.assign(m_size, 0);
+    m_span_len.assign(m_size, 0);
+
+    // The disk is convex, so each row's inside pixels are one span
+    std::vector<uint32_t> fill(m_bucket_start.begin(), m_bucket_start.end() - 1);
+    size_t n = 0;
+    for (size_t y = 0; y < m_size; y++) {
+        for (size_t x = 0; x < m_size; x++) {
+            uint16_t range = m_lookup.GetRange(x, y);
+            if (range == PolarLookup::OUTSIDE) continue;
+            uint32_t bucket = (uint32_t)((uint64_t)m_lookup.GetAngle(x, y) * spokes / 65536);
+            uint32_t sample = (uint32_t)((uint64_t)range * spoke_len / 65535);
+
+            uint32_t i = fill[bucket]++;
+            m_pixel_range[i] = sample;
+            m_pixel_index[i] = (uint32_t)(y * m_size + x);
+
+            if (m_span_len[y] == 0) m_span_x[y] = (uint32_t)x;
+            m_span_len[y]++;
+            m_span_bucket[n] = (int32_t)bucket;
+            m_span_range[n] = (int32_t)sample;
+            n++;
+        }
+    }
+
+    // Everything needed is in the tables above; m_table_size tells when
+    // to rebuild
+    m_lookup.Release();
+}
+
+bool RadarRasterizer::Update(SpokeBuffer* buffer) {
+    m_last_pixel_count = 0;
+    m_dirty_row_first = 0;
+    m_dirty_row_end = 0;
+    if (!buffer || m_size == 0) return false;
+
+    size_t spokes = buffer->GetSpokes();
+    size_t spoke_len = buffer->GetMaxSpokeLen();
+    if (spokes == 0 || spoke_len == 0) return false;
+
+    if (spokes != m_spokes || spoke_len != m_spoke_len || m_size != m_table_size) {
+        BuildTables(spokes, spoke_len);
+        m_full = true;
+    }
+    if (buffer->GetRowBytes() != m_row_bytes) {
+        m_row_bytes = buffer->GetRowBytes();
+        m_pack_shift = buffer->IsPacked() ? 1 : 0;
+        m_sample_mask = buffer->IsPacked() ? 0x0F : 0xFF;
+        m_full = true;
+    }
+    if (m_shift != m_applied_shift) {
+        m_full = true;
+    }
+
+    const uint8_t* data = buffer->GetTextureData();
+    if (m_full) {
+        m_last_pixel_count = RasterizeAll(data, buffer->GetTextureSize());
+        m_dirty_row_first = 0;
+        m_dirty_row_end = m_size;
+    } else {
+        // Only the wedge swept since last time; spoke k is shown in
+        // screen bucket k + shift
+        m_dirty_row_first = m_size;
+        m_dirty_row_end = 0;
+        buffer->GetDirtySector(m_sequence, m_dirty_runs);
+        for (const DirtyRun& run : m_dirty_runs) {
+            for (uint32_t k = run.first; k < run.first + run.count; k++) {
+                uint32_t bucket = (k + m_shift) % spokes;
+                m_last_pixel_count += RasterizeSpoke(data + (size_t)k * m_row_bytes, bucket);
+            }
+        }
+    }
+
+    m_sequence = buffer->GetSequence();
+    m_applied_shift = m_shift;
+    m_full = false;
+    return m_last_pixel_count > 0;
+}
+
+size_t RadarRasterizer::RasterizeSpoke(const uint8_t* row, uint32_t bucket) {
+    uint32_t begin = m_bucket_start[bucket];
+    uint32_t end = m_bucket_start[bucket + 1];
+    const uint32_t* range = m_pixel_range.data();
+    const uint32_t* index = m_pixel_index.data();
+    uint32_t* pixels = m_pixels.data();
+    const uint32_t p = m_pack_shift;
+    const uint32_t mask = m_sample_mask;
+
+    // Stores are scattered, so this stays scalar; a spoke is only a few
+    // hundred pixels
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t r = range[i];
+        pixels[index[i]] = m_lut[(row[r >> p] >> ((r & p) << 2)) & mask];
+    }
+
+    if (begin < end) {
+        m_dirty_row_first = std::min<size_t>(m_dirty_row_first, m_bucket_row_min[bucket]);
+        m_dirty_row_end = std::max<size_t>(m_dirty_row_end, m_bucket_row_max[bucket] + 1);
+    }
+
+    return end - begin;
+}
+
+size_t RadarRasterizer::RasterizeAll(const uint8_t* data, size_t data_size) {
+#if defined(MAYARA_X86)
+    // Samples are gathered as aligned dwords, which never cross the end
+    // of the buffer as long as its size is a multiple of 4
+    if (data_size % 4 == 0 && HasAVX2()) {
+        return RasterizeAllAVX2(data);
+    }
+#else
+    (void)data_size;
+#endif
+
+    const int32_t spokes = (int32_t)m_spokes;
+    const int32_t row_bytes = (int32_t)m_row_bytes;
+    const int32_t shift = (int32_t)m_shift;
+    const uint32_t p = m_pack_shift;
+    const uint32_t mask = m_sample_mask;
+    const int32_t* buckets = m_span_bucket.data();
+    const int32_t* ranges = m_span_range.data();
+    size_t n = 0;
+
+#if defined(MAYARA_SSE2) || defined(MAYARA_NEON)
+    // Sample offsets are computed 4 pixels at a time, the sample and color
+    // lookups are per lane (no gather below AVX2) and the 4 colors are
+    // stored as one vector. The SSE2 multiply works on 16-bit halves.
+    const bool use_vector = m_spokes <= 0xFFFF && m_row_bytes <= 0xFFFF;
+#endif
+#if defined(MAYARA_SSE2)
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128i v_spokes = _mm_set1_epi32(spokes);
+    const __m128i v_shift = _mm_set1_epi32(shift);
+    const __m128i v_len = _mm_set1_epi32(row_bytes);
+    const __m128i v_pack = _mm_set1_epi32(p);
+    const __m128i v_pack_shift = _mm_cvtsi32_si128(p);
+#elif defined(MAYARA_NEON)
+    const int32x4_t v_spokes = vdupq_n_s32(spokes);
+    const int32x4_t v_shift = vdupq_n_s32(shift);
+    const int32x4_t v_len = vdupq_n_s32(row_bytes);
+    const int32x4_t v_pack = vdupq_n_s32(p);
+    const int32x4_t v_pack_shift = vdupq_n_s32(-(int32_t)p);
+#endif
+
+    for (size_t y = 0; y < m_size; y++) {
+        uint32_t* dst = m_pixels.data() + y * m_size + m_span_x[y];
+        size_t len = m_span_len[y];
+        size_t x = 0;
+
+#if defined(MAYARA_SSE2)
+        for (; use_vector && x + 4 <= len; x += 4) {
+            __m128i spoke = _mm_sub_epi32(
+                _mm_loadu_si128((const __m128i*)(buckets + n + x)), v_shift);
+            spoke = _mm_add_epi32(spoke,
+                _mm_and_si128(_mm_cmplt_epi32(spoke, v_zero), v_spokes));
+            __m128i range = _mm_loadu_si128((const __m128i*)(ranges + n + x));
+            __m128i product = _mm_or_si128(_mm_mullo_epi16(spoke, v_len),
+                _mm_slli_epi32(_mm_mulhi_epu16(spoke, v_len), 16));
+            __m128i offset = _mm_add_epi32(product, _mm_srl_epi32(range, v_pack_shift));
+            __m128i bits = _mm_slli_epi32(_mm_and_si128(range, v_pack), 2);
+            uint32_t c0 = m_lut[(data[_mm_cvtsi128_si32(offset)] >> _mm_cvtsi128_si32(bits)) & mask];
+            uint32_t c1 = m_lut[(data[_mm_cvtsi128_si32(_mm_shuffle_epi32(offset, 1))] >>
+                                 _mm_cvtsi128_si32(_mm_shuffle_epi32(bits, 1))) & mask];
+            uint32_t c2 = m_lut[(data[_mm_cvtsi128_si32(_mm_shuffle_epi32(offset, 2))] >>
+                                 _mm_cvtsi128_si32(_mm_shuffle_epi32(bits, 2))) & mask];
+            uint32_t c3 = m_lut[(data[_mm_cvtsi128_si32(_mm_shuffle_epi32(offset, 3))] >>
+                                 _mm_cvtsi128_si32(_mm_shuffle_epi32(bits, 3))) & mask];
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_set_epi32(c3, c2, c1, c0));
+        }
+#elif defined(MAYARA_NEON)
+        for (; use_vector && x + 4 <= len; x += 4) {
+            int32x4_t spoke = vsubq_s32(vld1q_s32(buckets + n + x), v_shift);
+            spoke = vaddq_s32(spoke, vandq_s32(
+                vreinterpretq_s32_u32(vcltq_s32(spoke, vdupq_n_s32(0))), v_spokes));
+            int32x4_t range = vld1q_s32(ranges + n + x);
+            uint32x4_t offset = vreinterpretq_u32_s32(vaddq_s32(vmulq_s32(spoke, v_len),
+                vshlq_s32(range, v_pack_shift)));
+            uint32x4_t bits = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(range, v_pack), 2));
+            uint32x4_t rgba = vdupq_n_u32(0);
+            rgba = vsetq_lane_u32(
+                m_lut[(data[vgetq_lane_u32(offset, 0)] >> vgetq_lane_u32(bits, 0)) & mask], rgba, 0);
+            rgba = vsetq_lane_u32(
+                m_lut[(data[vgetq_lane_u32(offset, 1)] >> vgetq_lane_u32(bits, 1)) & mask], rgba, 1);
+            rgba = vsetq_lane_u32(
+                m_lut[(data[vgetq_lane_u32(offset, 2)] >> vgetq_lane_u32(bits, 2)) & mask], rgba, 2);
+            rgba = vsetq_lane_u32(
+                m_lut[(data[vgetq_lane_u32(offset, 3)] >> vgetq_lane_u32(bits, 3)) & mask], rgba, 3);
+            vst1q_u32(dst + x, rgba);
+        }
+#endif
+
+        for (; x < len; x++) {
+            int32_t spoke = buckets[n + x] - shift;
+            if (spoke < 0) spoke += spokes;
+            uint32_t r = (uint32_t)ranges[n + x];
+            uint8_t bits = data[spoke * row_bytes + (r >> p)];
+            dst[x] = m_lut[(bits >> ((r & p) << 2)) & mask];
+        }
+
+        n += len;
+    }
+
+    return n;
+}
+
+#if defined(MAYARA_X86)
+MAYARA_TARGET_AVX2
+size_t RadarRasterizer::RasterizeAllAVX2(const uint8_t* data) {
+    const int32_t spokes = (int32_t)m_spokes;
+    const int32_t row_bytes = (int32_t)m_row_bytes;
+    const int32_t shift = (int32_t)m_shift;
+    const uint32_t p = m_pack_shift;
+    const uint32_t mask = m_sample_mask;
+    const int32_t* buckets = m_span_bucket.data();
+    const int32_t* ranges = m_span_range.data();
+    size_t n = 0;
+
+    const __m256i v_zero = _mm256_setzero_si256();
+    const __m256i v_spokes = _mm256_set1_epi32(spokes);
+    const __m256i v_shift = _mm256_set1_epi32(shift);
+    const __m256i v_len = _mm256_set1_epi32(row_bytes);
+    const __m256i v_align = _mm256_set1_epi32(~3);
+    const __m256i v_three = _mm256_set1_epi32(3);
+    const __m256i v_mask = _mm256_set1_epi32(mask);
+    const __m256i v_pack = _mm256_set1_epi32(p);
+    const __m128i v_pack_shift = _mm_cvtsi32_si128(p);
+
+    for (size_t y = 0; y < m_size; y++) {
+        uint32_t* dst = m_pixels.data() + y * m_size + m_span_x[y];
+        size_t len = m_span_len[y];
+        size_t x = 0;
+
+        // 8 pixels at a time: spoke = bucket - shift (mod spokes), then
+        // gather the sample, then gather its palette color
+        for (; x + 8 <= len; x += 8) {
+            __m256i spoke = _mm256_sub_epi32(
+                _mm256_loadu_si256((const __m256i*)(buckets + n + x)), v_shift);
+            spoke = _mm256_add_epi32(spoke,
+                _mm256_and_si256(_mm256_cmpgt_epi32(v_zero, spoke), v_spokes));
+            __m256i range = _mm256_loadu_si256((const __m256i*)(ranges + n + x));
+            __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(spoke, v_len),
+                _mm256_srl_epi32(range, v_pack_shift));
+
+            // Bit position: byte within the dword, plus the nibble
+            __m256i bits = _mm256_add_epi32(
+                _mm256_slli_epi32(_mm256_and_si256(offset, v_three), 3),
+                _mm256_slli_epi32(_mm256_and_si256(range, v_pack), 2));
+            __m256i dword = _mm256_i32gather_epi32((const int*)data,
+                _mm256_and_si256(offset, v_align), 1);
+            __m256i sample = _mm256_and_si256(_mm256_srlv_epi32(dword, bits), v_mask);
+            __m256i rgba = _mm256_i32gather_epi32((const int*)m_lut, sample, 4);
+            _mm256_storeu_si256((__m256i*)(dst + x), rgba);
+        }
+
+        for (; x < len; x++) {
+            int32_t spoke = buckets[n + x] - shift;
+            if (spoke < 0) spoke += spokes;
+            uint32_t r = (uint32_t)ranges[n + x];
+            uint8_t bits = data[spoke * row_bytes + (r >> p)];
+            dst[x] = m_lut[(bits >> ((r & p) << 2)) & mask];
+        }
+
+        n += len;
+    }
+
+    return n;
+}
+#endif
@@ -13,45 +13,178 @@
 
 #include "RadarRenderer.h"
 #include "SpokeBuffer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 using namespace mayara;
 
+// Pixel buffer objects are core in GL 2.1, or available as an extension
+static bool IsPBOSupported() {
+    if (!HaveGLBufferFunctions()) return false;
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version && sscanf(version, "%d.%d", &major, &minor) == 2) {
+        if (major > 2 || (major == 2 && minor >= 1)) return true;
+    }
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions &&
+           (strstr(extensions, "GL_ARB_pixel_buffer_object") ||
+            strstr(extensions, "GL_EXT_pixel_buffer_object"));
+}
+
+// Fragment shader prelude defining SampleSpoke() for the texture layout
+static std::string GetSampleSource(size_t samples, size_t row_bytes, bool packed) {
+    // Spoke ages are 0..1 over the afterglow span, the afterglow uniform
+    // is the span in time constants (0 when off)
+    std::string source =
+        "#version 120\n"
+        "uniform sampler2D radar_texture;\n"
+        "uniform sampler1D spoke_age;\n"
+        "uniform float afterglow;\n"
+        "float SpokeAfterglow(float angle) {\n"
+        "    return exp(-afterglow * texture1D(spoke_age, angle).r);\n"
+        "}\n";
+
+    if (!packed) {
+        return source +
+            "float SampleSpoke(vec2 pos) {\n"
+            "    return texture2D(radar_texture, pos).r;\n"
+            "}\n";
+    }
+
+    // Pick the nearest sample, fetch its byte and take the low nibble for
+    // even samples, the high one for odd
+    char sizes[128];
+    snprintf(sizes, sizeof(sizes),
+             "const float SAMPLES = %zu.0;\n"
+             "const float TEXELS = %zu.0;\n",
+             samples, row_bytes);
+    return source + sizes +
+        "float SampleSpoke(vec2 pos) {\n"
+        "    float index = clamp(floor(pos.x * SAMPLES), 0.0, SAMPLES - 1.0);\n"
+        "    float texel = floor(index * 0.5);\n"
+        "    float bits = floor(texture2D(radar_texture,\n"
+        "        vec2((texel + 0.5) / TEXELS, pos.y)).r * 255.0 + 0.5);\n"
+        "    float high = floor(bits / 16.0);\n"
+        "    float value = index - texel * 2.0 > 0.5 ? high : bits - high * 16.0;\n"
+        "    return value / 255.0;\n"
+        "}\n";
+}
+
 RadarRenderer::RadarRenderer()
     : m_program(0)
     , m_vertex_shader(0)
     , m_fragment_shader(0)
     , m_texture(0)
     , m_palette_texture(0)
+    , m_quad_vbo(0)
+    , m_loc_age_texture(-1)
+    , m_loc_afterglow(-1)
+    , m_lookup_program(0)
+    , m_lookup_vertex_shader(0)
+    , m_lookup_fragment_shader(0)
+    , m_lookup_texture(0)
+    , m_lookup_texture_size(0)
+    , m_lookup_max_size(0)
+    , m_use_lookup(false)
+    , m_lookup_loc_position(-1)
+    , m_lookup_loc_center(-1)
+    , m_lookup_loc_scale(-1)
+    , m_lookup_loc_rotation(-1)
+    , m_lookup_loc_texture(-1)
+    , m_lookup_loc_palette(-1)
+    , m_lookup_loc_lookup(-1)
+    , m_lookup_loc_age_texture(-1)
+    , m_lookup_loc_afterglow(-1)
+    , m_trail_program(0)
+    , m_trail_vertex_shader(0)
+    , m_trail_fragment_shader(0)
+    , m_trail_texture(0)
+    , m_trail_texture_size(0)
+    , m_trail_generation(0)
+    , m_trails_visible(false)
+    , m_trail_length(60.0)
+    , m_trail_origin_x(0.0f)
+    , m_trail_origin_y(0.0f)
+    , m_trail_now(0.0f)
+    , m_trail_heading(0.0f)
+    , m_trail_loc_position(-1)
+    , m_trail_loc_center(-1)
+    , m_trail_loc_scale(-1)
+    , m_trail_loc_rotation(-1)
+    , m_trail_loc_texture(-1)
+    , m_trail_loc_origin(-1)
+    , m_trail_loc_now(-1)
+    , m_trail_loc_length(-1)
+    , m_raster_texture(0)
+    , m_raster_texture_size(0)
+    , m_afterglow(0.0)
+    , m_age_texture(0)
+    , m_newest_spoke_time(0)
+    , m_newest_spoke_seen(0)
     , m_spokes(0)
     , m_spoke_len_max(0)
+    , m_packed(false)
+    , m_row_bytes(0)
     , m_initialized(false)
     , m_texture_dirty(true)
+    , m_uploaded_sequence(0)
+    , m_last_upload_bytes(0)
+    , m_total_upload_bytes(0)
+    , m_pbo_index(0)
+    , m_pbo_size(0)
+    , m_pbo_supported(false)
+    , m_use_pbo(true)
 {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        m_pbo[i] = 0;
+    }
 }
 
 RadarRenderer::~RadarRenderer() {
     Reset();
 }
 
-bool RadarRenderer::Init(size_t spokes, size_t maxSpokeLen) {
+bool RadarRenderer::Init(size_t spokes, size_t maxSpokeLen, bool packed) {
     wxCriticalSectionLocker lock(m_lock);
 
     m_spokes = spokes;
     m_spoke_len_max = maxSpokeLen;
+    m_packed = packed;
+    m_row_bytes = packed ? (maxSpokeLen + 1) / 2 : maxSpokeLen;
+    m_sample_source = GetSampleSource(maxSpokeLen, m_row_bytes, packed);
+
+    // Load extension entry points (no-op except on Windows)
+    InitGLFunctions();
 
     // Create radar texture
+    // Packed bytes hold two samples, filtering them would mix nibbles
+    GLint filter = packed ? GL_NEAREST : GL_LINEAR;
     glGenTextures(1, &m_texture);
     glBindTexture(GL_TEXTURE_2D, m_texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Angle wraps around, so filtering between the last and first spoke
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    // Allocate texture (spokes x spoke_len, single channel)
+    // Allocate texture (spokes x row bytes, single channel)
     glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE,
-                 maxSpokeLen, spokes, 0,
+                 m_row_bytes, spokes, 0,
                  GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
 
+    // Texture content is undefined until the first full upload
+    m_texture_dirty = true;
+
+    // Streaming upload buffers, each large enough for the whole texture
+    m_pbo_supported = IsPBOSupported();
+    if (m_pbo_supported) {
+        CreatePBOs(spokes * m_row_bytes);
+    }
+
     // Create palette texture (256 x 1, RGBA)
     glGenTextures(1, &m_palette_texture);
     glBindTexture(GL_TEXTURE_1D, m_palette_texture);
@@ -60,6 +193,40 @@ bool RadarRenderer::Init(size_t spokes, size_t maxSpokeLen) {
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, 256, 0, GL_RGBA, GL_UNSIGNED_BYTE,
                  m_palette.GetLUT());
 
+    // Spoke age texture (spokes x 1), indexed by angle like the radar
+    // texture rows. Starts out fully aged.
+    m_ages.assign(spokes, 1.0f);
+    glGenTextures(1, &m_age_texture);
+    glBindTexture(GL_TEXTURE_1D, m_age_texture);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_LUMINANCE16, spokes, 0,
+                 GL_LUMINANCE, GL_FLOAT, m_ages.data());
+    m_newest_spoke_time = 0;
+
+    // Unit quad for the polar shaders, kept on the GPU
+    if (HaveGLBufferFunctions()) {
+        static const GLfloat quad[] = {
+            -1.0f, -1.0f,
+             1.0f, -1.0f,
+             1.0f,  1.0f,
+            -1.0f,  1.0f
+        };
+        glGenBuffers(1, &m_quad_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Optional lookup texture path, the table itself is built on first draw
+    if (!CompileLookupShaders()) {
+        wxLogMessage("MaYaRa: Polar lookup shaders unavailable");
+    }
+    if (!CompileTrailShaders()) {
+        wxLogMessage("MaYaRa: Trail shaders unavailable");
+    }
+
     m_initialized = true;
     return true;
 }
@@ -75,6 +242,55 @@ void RadarRenderer::Reset() {
         glDeleteTextures(1, &m_palette_texture);
         m_palette_texture = 0;
     }
+    if (m_age_texture) {
+        glDeleteTextures(1, &m_age_texture);
+        m_age_texture = 0;
+    }
+    if (m_quad_vbo) {
+        glDeleteBuffers(1, &m_quad_vbo);
+        m_quad_vbo = 0;
+    }
+    DeletePBOs();
+    if (m_raster_texture) {
+        glDeleteTextures(1, &m_raster_texture);
+        m_raster_texture = 0;
+        m_raster_texture_size = 0;
+    }
+    if (m_lookup_texture) {
+        glDeleteTextures(1, &m_lookup_texture);
+        m_lookup_texture = 0;
+        m_lookup_texture_size = 0;
+    }
+    if (m_lookup_program) {
+        glDeleteProgram(m_lookup_program);
+        m_lookup_program = 0;
+    }
+    if (m_trail_texture) {
+        glDeleteTextures(1, &m_trail_texture);
+        m_trail_texture = 0;
+        m_trail_texture_size = 0;
+    }
+    if (m_trail_program) {
+        glDeleteProgram(m_trail_program);
+        m_trail_program = 0;
+    }
+    if (m_trail_vertex_shader) {
+        glDeleteShader(m_trail_vertex_shader);
+        m_trail_vertex_shader = 0;
+    }
+    if (m_trail_fragment_shader) {
+        glDeleteShader(m_trail_fragment_shader);
+        m_trail_fragment_shader = 0;
+    }
+    m_trails_visible = false;
+    if (m_lookup_vertex_shader) {
+        glDeleteShader(m_lookup_vertex_shader);
+        m_lookup_vertex_shader = 0;
+    }
+    if (m_lookup_fragment_shader) {
+        glDeleteShader(m_lookup_fragment_shader);
+        m_lookup_fragment_shader = 0;
+    }
     if (m_program) {
         glDeleteProgram(m_program);
         m_program = 0;
@@ -96,20 +312,170 @@ void RadarRenderer::UpdateTexture(SpokeBuffer* buffer) {
 
     wxCriticalSectionLocker lock(m_lock);
 
-    // Upload texture data
-    glBindTexture(GL_TEXTURE_2D, m_texture);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                    buffer->GetMaxSpokeLen(), buffer->GetSpokes(),
-                    GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                    buffer->GetTextureData());
+    // Pull spokes queued by the ingest thread into the texture data
+    buffer->Drain();
 
+    if (UseRasterizer()) {
+        UpdateRasterTexture(buffer);
+        return;
+    }
+
+    UpdateAgeTexture(buffer);
+
+    // Sector swept since our last upload, at most two row runs
+    if (m_texture_dirty) {
+        m_dirty_runs.assign(1, DirtyRun{0, (uint32_t)buffer->GetSpokes()});
+    } else {
+        buffer->GetDirtySector(m_uploaded_sequence, m_dirty_runs);
+    }
+
+    m_last_upload_bytes = 0;
+    if (!m_dirty_runs.empty()) {
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        // Fall back to client memory if the PBO can't be mapped
+        if (!IsUsingPBO() || !UploadRunsPBO(buffer)) {
+            UploadRuns(buffer);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    m_total_upload_bytes += m_last_upload_bytes;
+
+    m_uploaded_sequence = buffer->GetSequence();
     m_texture_dirty = false;
 }
 
+void RadarRenderer::UploadRuns(SpokeBuffer* buffer) {
+    size_t row_len = buffer->GetRowBytes();
+
+    // Upload each run of changed rows straight from the spoke buffer.
+    // The driver copies the data before returning, stalling this thread.
+    for (const DirtyRun& run : m_dirty_runs) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, run.first,
+                        row_len, run.count,
+                        GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                        buffer->GetTextureData() + run.first * row_len);
+        m_last_upload_bytes += run.count * row_len;
+    }
+}
+
+bool RadarRenderer::UploadRunsPBO(SpokeBuffer* buffer) {
+    size_t row_len = buffer->GetRowBytes();
+    if (buffer->GetTextureSize() > m_pbo_size) return false;
+
+    GLuint pbo = m_pbo[m_pbo_index];
+    m_pbo_index = (m_pbo_index + 1) % PBO_COUNT;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+    // Orphan the old storage first: if the GPU is still sourcing it, the
+    // driver hands out fresh memory instead of blocking the map
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, m_pbo_size, nullptr, GL_STREAM_DRAW);
+    uint8_t* dst = (uint8_t*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!dst) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // Pack the changed rows into the mapped buffer, then let the driver
+    // transfer them to the texture asynchronously
+    const uint8_t* src = buffer->GetTextureData();
+    size_t offset = 0;
+    for (const DirtyRun& run : m_dirty_runs) {
+        size_t bytes = run.count * row_len;
+        std::memcpy(dst + offset, src + run.first * row_len, bytes);
+        offset += bytes;
+    }
+
+    if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+        // Buffer contents were lost (e.g. display mode change)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // With a PBO bound the data pointer is an offset into the buffer
+    offset = 0;
+    for (const DirtyRun& run : m_dirty_runs) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, run.first,
+                        row_len, run.count,
+                        GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                        (const GLvoid*)offset);
+        offset += run.count * row_len;
+    }
+    m_last_upload_bytes += offset;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void RadarRenderer::UpdateAgeTexture(SpokeBuffer* buffer) {
+    if (m_afterglow <= 0.0 || !m_age_texture) return;
+
+    size_t spokes = std::min(buffer->GetSpokes(), m_ages.size());
+    const int32_t* times = buffer->GetSpokeTimes();
+
+    // Ages count from the newest spoke rather than the local clock, which
+    // need not agree with the server's, plus the local time since that
+    // spoke was first drawn so echoes keep fading if the radar goes quiet
+    int32_t newest = SpokeBuffer::NO_TIME;
+    for (size_t i = 0; i < spokes; i++) {
+        newest = std::max(newest, times[i]);
+    }
+    if (newest == SpokeBuffer::NO_TIME) return;
+
+    int64_t now = wxGetLocalTimeMillis().GetValue();
+    uint64_t newest_time = buffer->GetTimeEpoch() + newest;
+    if (newest_time != m_newest_spoke_time) {
+        m_newest_spoke_time = newest_time;
+        m_newest_spoke_seen = now;
+    }
+
+    // Times are relative to the buffer's epoch, ms
+    double reference = newest + (double)(now - m_newest_spoke_seen);
+    double scale = 1.0 / (AFTERGLOW_SPAN * m_afterglow * 1000.0);
+    for (size_t i = 0; i < spokes; i++) {
+        if (times[i] == SpokeBuffer::NO_TIME) {
+            m_ages[i] = 1.0f;
+        } else {
+            m_ages[i] = (float)std::min((reference - times[i]) * scale, 1.0);
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_1D, m_age_texture);
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, spokes,
+                    GL_LUMINANCE, GL_FLOAT, m_ages.data());
+}
+
+void RadarRenderer::CreatePBOs(size_t size) {
+    DeletePBOs();
+
+    glGenBuffers(PBO_COUNT, m_pbo);
+    for (int i = 0; i < PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_pbo_size = size;
+    m_pbo_index = 0;
+}
+
+void RadarRenderer::DeletePBOs() {
+    if (m_pbo[0]) {
+        glDeleteBuffers(PBO_COUNT, m_pbo);
+        for (int i = 0; i < PBO_COUNT; i++) {
+            m_pbo[i] = 0;
+        }
+    }
+    m_pbo_size = 0;
+}
+
 void RadarRenderer::SetColorPalette(const ColorPalette& palette) {
     wxCriticalSectionLocker lock(m_lock);
 
     m_palette = palette;
+    m_rasterizer.SetColorPalette(palette);
 
     // Update palette texture
     if (m_palette_texture) {
@@ -119,6 +485,108 @@ void RadarRenderer::SetColorPalette(const ColorPalette& palette) {
     }
 }
 
+void RadarRenderer::UpdateRasterTexture(SpokeBuffer* buffer) {
+    // Size is picked by the last DrawRasterQuad(), nothing to do before that
+    m_last_upload_bytes = 0;
+    if (!m_rasterizer.Update(buffer)) return;
+
+    size_t size = m_rasterizer.GetSize();
+    if (!m_raster_texture) {
+        glGenTextures(1, &m_raster_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_raster_texture);
+
+    if (m_raster_texture_size != size) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, m_rasterizer.GetPixels());
+        m_raster_texture_size = size;
+        m_last_upload_bytes = size * size * 4;
+    } else {
+        // Only the rows the swept wedge touched
+        size_t first, count;
+        m_rasterizer.GetDirtyRows(first, count);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, size, count,
+                        GL_RGBA, GL_UNSIGNED_BYTE,
+                        m_rasterizer.GetPixels() + first * size * 4);
+        m_last_upload_bytes = count * size * 4;
+    }
+    m_total_upload_bytes += m_last_upload_bytes;
+}
+
+void RadarRenderer::DrawRasterQuad(float cx, float cy, float radius, float rotation) {
+    // Roughly one bitmap pixel per screen pixel; the new size takes effect
+    // at the next UpdateTexture()
+    size_t size = 64;
+    while (size < 2.0f * radius && size < 1024) size <<= 1;
+    m_rasterizer.SetSize(size);
+    m_rasterizer.SetRotation(0.0);  // GL rotates the quad instead
+
+    if (!m_raster_texture) return;
+
+    glPushMatrix();
+    glTranslatef(cx, cy, 0);
+    glRotatef(RadToDeg(rotation), 0, 0, 1);
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, m_raster_texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    // Bitmap row 0 is the bow
+    glBegin(GL_QUADS);
+    glTexCoord2f(0, 0);
+    glVertex2f(-radius, -radius);
+    glTexCoord2f(1, 0);
+    glVertex2f(radius, -radius);
+    glTexCoord2f(1, 1);
+    glVertex2f(radius, radius);
+    glTexCoord2f(0, 1);
+    glVertex2f(-radius, radius);
+    glEnd();
+
+    glDisable(GL_TEXTURE_2D);
+    glPopMatrix();
+}
+
+void RadarRenderer::BindRadarTextures() {
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_1D, m_palette_texture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+}
+
+void RadarRenderer::SetAfterglowUniforms(GLint loc_age_texture, GLint loc_afterglow) {
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_1D, m_age_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(loc_age_texture, 3);
+    glUniform1f(loc_afterglow, m_afterglow > 0.0 ? AFTERGLOW_SPAN : 0.0f);
+}
+
+void RadarRenderer::DrawUnitQuad(GLint loc_position) {
+    glEnableVertexAttribArray(loc_position);
+    if (m_quad_vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+        glVertexAttribPointer(loc_position, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        static const GLfloat quad[] = {
+            -1.0f, -1.0f,
+             1.0f, -1.0f,
+             1.0f,  1.0f,
+            -1.0f,  1.0f
+        };
+        glVertexAttribPointer(loc_position, 2, GL_FLOAT, GL_FALSE, 0, quad);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    }
+    glDisableVertexAttribArray(loc_position);
+}
+
 bool RadarRenderer::CompileShaders() {
     // Subclasses override this
     return false;
@@ -134,6 +602,7 @@ GLuint RadarRenderer::CompileShader(GLenum type, const char* source) {
     if (status != GL_TRUE) {
         char log[512];
         glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        wxLogMessage("MaYaRa: Shader compile failed: %s", log);
         glDeleteShader(shader);
         return 0;
     }
@@ -141,23 +610,310 @@ GLuint RadarRenderer::CompileShader(GLenum type, const char* source) {
     return shader;
 }
 
+GLuint RadarRenderer::CompileFragmentShader(const char* source) {
+    std::string full = m_sample_source + source;
+    return CompileShader(GL_FRAGMENT_SHADER, full.c_str());
+}
+
 bool RadarRenderer::LinkProgram() {
-    if (!m_vertex_shader || !m_fragment_shader) return false;
+    m_program = LinkProgram(m_vertex_shader, m_fragment_shader);
+    if (!m_program) return false;
+
+    m_loc_age_texture = glGetUniformLocation(m_program, "spoke_age");
+    m_loc_afterglow = glGetUniformLocation(m_program, "afterglow");
+    return true;
+}
+
+GLuint RadarRenderer::LinkProgram(GLuint vertex_shader, GLuint fragment_shader) {
+    if (!vertex_shader || !fragment_shader) return 0;
 
-    m_program = glCreateProgram();
-    glAttachShader(m_program, m_vertex_shader);
-    glAttachShader(m_program, m_fragment_shader);
-    glLinkProgram(m_program);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
 
     GLint status;
-    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
     if (status != GL_TRUE) {
         char log[512];
-        glGetProgramInfoLog(m_program, sizeof(log), nullptr, log);
-        glDeleteProgram(m_program);
-        m_program = 0;
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        wxLogMessage("MaYaRa: Shader link failed: %s", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// Same quad transform as the analytic polar shaders
+static const char* s_lookup_vertex_shader = R"(
+    #version 120
+    attribute vec2 position;
+    varying vec2 v_pos;
+    uniform vec2 center;
+    uniform float scale;
+    uniform float rotation;
+
+    void main() {
+        float c = cos(rotation);
+        float s = sin(rotation);
+        vec2 p = vec2(position.x * c - position.y * s,
+                      position.x * s + position.y * c);
+        gl_Position = gl_ModelViewProjectionMatrix *
+                      vec4(center + p * scale, 0.0, 1.0);
+        v_pos = position;
+    }
+)";
+
+static const char* s_lookup_fragment_shader = R"(
+    varying vec2 v_pos;
+    uniform sampler1D palette;
+    uniform sampler2D lookup;
+
+    void main() {
+        // Dependent fetch: luminance is range, alpha is angle
+        vec4 polar = texture2D(lookup, v_pos * 0.5 + 0.5);
+        if (polar.r >= 1.0) discard;
+
+        float intensity = SampleSpoke(vec2(polar.r, polar.a));
+        gl_FragColor = texture1D(palette, (intensity * 255.0 + 0.5) / 256.0);
+        gl_FragColor.a *= SpokeAfterglow(polar.a);
+    }
+)";
+
+bool RadarRenderer::CompileLookupShaders() {
+    if (!InitGLFunctions()) return false;
+
+    m_lookup_vertex_shader = CompileShader(GL_VERTEX_SHADER, s_lookup_vertex_shader);
+    m_lookup_fragment_shader = CompileFragmentShader(s_lookup_fragment_shader);
+    m_lookup_program = LinkProgram(m_lookup_vertex_shader, m_lookup_fragment_shader);
+    if (!m_lookup_program) return false;
+
+    m_lookup_loc_position = glGetAttribLocation(m_lookup_program, "position");
+    m_lookup_loc_center = glGetUniformLocation(m_lookup_program, "center");
+    m_lookup_loc_scale = glGetUniformLocation(m_lookup_program, "scale");
+    m_lookup_loc_rotation = glGetUniformLocation(m_lookup_program, "rotation");
+    m_lookup_loc_texture = glGetUniformLocation(m_lookup_program, "radar_texture");
+    m_lookup_loc_palette = glGetUniformLocation(m_lookup_program, "palette");
+    m_lookup_loc_lookup = glGetUniformLocation(m_lookup_program, "lookup");
+    m_lookup_loc_age_texture = glGetUniformLocation(m_lookup_program, "spoke_age");
+    m_lookup_loc_afterglow = glGetUniformLocation(m_lookup_program, "afterglow");
+
+    // Table size is bounded by memory (16 MB at 2048) and the driver
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    m_lookup_max_size = std::min<size_t>(2048, max_size > 0 ? max_size : 0);
+
+    if (m_lookup_loc_position < 0 || m_lookup_max_size == 0) {
+        glDeleteProgram(m_lookup_program);
+        m_lookup_program = 0;
         return false;
     }
 
     return true;
 }
+
+bool RadarRenderer::UpdateLookupTexture(size_t size) {
+    if (m_lookup_texture && m_lookup_texture_size == size) return true;
+
+    m_lookup.Build(size);
+
+    if (!m_lookup_texture) {
+        glGenTextures(1, &m_lookup_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_lookup_texture);
+
+    // Interpolating coordinates would smear the seam at the bow
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE16_ALPHA16,
+                 size, size, 0,
+                 GL_LUMINANCE_ALPHA, GL_UNSIGNED_SHORT, m_lookup.GetTable());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // The texture is the only copy needed; m_lookup_texture_size tells
+    // when to rebuild
+    m_lookup.Release();
+
+    // Drivers may store legacy formats at lower precision, which would
+    // band the angle; give up on the lookup path in that case
+    GLint bits = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_LUMINANCE_SIZE, &bits);
+    if (bits < 16) {
+        wxLogMessage("MaYaRa: Polar lookup needs 16 bit textures, got %d", bits);
+        glDeleteTextures(1, &m_lookup_texture);
+        m_lookup_texture = 0;
+        m_lookup_texture_size = 0;
+        glDeleteProgram(m_lookup_program);
+        m_lookup_program = 0;
+        return false;
+    }
+
+    m_lookup_texture_size = size;
+    return true;
+}
+
+bool RadarRenderer::DrawLookupQuad(float cx, float cy, float radius, float rotation) {
+    // One table texel per screen pixel or better. Only grow the table:
+    // a larger one still samples correctly, and zooming out and back in
+    // must not rebuild it every time.
+    size_t needed = 64;
+    while (needed < 2.0f * radius) needed <<= 1;
+    if (needed > m_lookup_max_size) return false;
+
+    size_t size = std::max(needed, m_lookup_texture_size);
+    if (!UpdateLookupTexture(size)) return false;
+
+    glUseProgram(m_lookup_program);
+
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, m_lookup_texture);
+    BindRadarTextures();
+
+    glUniform1i(m_lookup_loc_texture, 0);
+    glUniform1i(m_lookup_loc_palette, 1);
+    glUniform1i(m_lookup_loc_lookup, 2);
+    glUniform2f(m_lookup_loc_center, cx, cy);
+    glUniform1f(m_lookup_loc_scale, radius);
+    glUniform1f(m_lookup_loc_rotation, rotation);
+    SetAfterglowUniforms(m_lookup_loc_age_texture, m_lookup_loc_afterglow);
+
+    DrawUnitQuad(m_lookup_loc_position);
+
+    glUseProgram(0);
+    return true;
+}
+
+// Trail cells are looked up in world cells around own ship; the texture
+// repeats, which is the toroidal addressing of the TrailBuffer
+static const char* s_trail_fragment_shader = R"(
+    #version 120
+    varying vec2 v_pos;
+    uniform sampler2D trail_texture;
+    uniform vec2 origin;
+    uniform float now;
+    uniform float trail_length;
+
+    void main() {
+        if (length(v_pos) > 1.0) discard;
+
+        // The disk radius is half the grid, x east and y south
+        vec4 texel = texture2D(trail_texture, origin + v_pos * 0.5);
+        float stamp = floor(texel.r * 255.0 + 0.5) + 256.0 * floor(texel.a * 255.0 + 0.5);
+        if (stamp == 0.0) discard;
+
+        float age = mod(now - stamp + 65536.0, 65536.0);
+        if (age >= trail_length) discard;
+
+        gl_FragColor = vec4(0.75, 0.85, 1.0, 0.6 * (1.0 - age / trail_length));
+    }
+)";
+
+bool RadarRenderer::CompileTrailShaders() {
+    if (!InitGLFunctions()) return false;
+
+    m_trail_vertex_shader = CompileShader(GL_VERTEX_SHADER, s_lookup_vertex_shader);
+    m_trail_fragment_shader = CompileShader(GL_FRAGMENT_SHADER, s_trail_fragment_shader);
+    m_trail_program = LinkProgram(m_trail_vertex_shader, m_trail_fragment_shader);
+    if (!m_trail_program) return false;
+
+    m_trail_loc_position = glGetAttribLocation(m_trail_program, "position");
+    m_trail_loc_center = glGetUniformLocation(m_trail_program, "center");
+    m_trail_loc_scale = glGetUniformLocation(m_trail_program, "scale");
+    m_trail_loc_rotation = glGetUniformLocation(m_trail_program, "rotation");
+    m_trail_loc_texture = glGetUniformLocation(m_trail_program, "trail_texture");
+    m_trail_loc_origin = glGetUniformLocation(m_trail_program, "origin");
+    m_trail_loc_now = glGetUniformLocation(m_trail_program, "now");
+    m_trail_loc_length = glGetUniformLocation(m_trail_program, "trail_length");
+
+    if (m_trail_loc_position < 0) {
+        glDeleteProgram(m_trail_program);
+        m_trail_program = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void RadarRenderer::UpdateTrails(TrailBuffer* trails) {
+    wxCriticalSectionLocker lock(m_lock);
+
+    m_trails_visible = false;
+    if (!trails || !m_initialized || !m_trail_program ||
+        trails->GetMode() == TrailMode::Off || trails->GetCellMeters() <= 0.0) {
+        return;
+    }
+
+    size_t size = trails->GetSize();
+    if (!m_trail_texture) {
+        glGenTextures(1, &m_trail_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_trail_texture);
+
+    // Stamps are uint16 in host order, which on every platform OpenCPN
+    // runs on puts the low byte first
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    if (m_trail_texture_size != size) {
+        // Stamps must not be interpolated; the grid wraps both ways
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, size, size, 0,
+                     GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, trails->GetStamps());
+        m_trail_texture_size = size;
+    } else {
+        // Runs of rows changed since our last upload
+        const uint32_t* generations = trails->GetRowGenerations();
+        size_t row = 0;
+        while (row < size) {
+            if (generations[row] <= m_trail_generation) {
+                row++;
+                continue;
+            }
+            size_t first = row;
+            while (row < size && generations[row] > m_trail_generation) row++;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, size, row - first,
+                            GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
+                            trails->GetStamps() + first * size);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    m_trail_generation = trails->GetGeneration();
+
+    m_trail_origin_x = (float)(trails->GetShipX() / size);
+    m_trail_origin_y = (float)(trails->GetShipY() / size);
+    m_trail_now = trails->GetNow();
+    m_trail_heading = (float)trails->GetHeading();
+    m_trails_visible = true;
+}
+
+void RadarRenderer::DrawTrails(float cx, float cy, float radius, float rotation) {
+    if (!m_trails_visible || !m_trail_program) return;
+
+    float length = (float)std::min(m_trail_length * 1000.0 / TrailBuffer::TICK_MS,
+                                   (double)TrailBuffer::MAX_LENGTH_TICKS);
+    if (length < 1.0f) return;
+
+    glUseProgram(m_trail_program);
+
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, m_trail_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(m_trail_loc_texture, 4);
+    glUniform2f(m_trail_loc_center, cx, cy);
+    glUniform1f(m_trail_loc_scale, radius);
+    glUniform1f(m_trail_loc_rotation, rotation - (float)DegToRad(m_trail_heading));
+    glUniform2f(m_trail_loc_origin, m_trail_origin_x, m_trail_origin_y);
+    glUniform1f(m_trail_loc_now, m_trail_now);
+    glUniform1f(m_trail_loc_length, length);
+
+    DrawUnitQuad(m_trail_loc_position);
+
+    glUseProgram(0);
+}
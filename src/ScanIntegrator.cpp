@@ -0,0 +1,203 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Scan-to-scan correlation over the last revolutions of each spoke
+ */
+
+#include "ScanIntegrator.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace mayara;
+
+ScanIntegrator::ScanIntegrator(size_t spokes, size_t max_spoke_len, size_t revolutions,
+                               IntegrationMode mode)
+    : m_spokes(spokes)
+    , m_max_spoke_len(max_spoke_len)
+    , m_revolutions(std::min(std::max<size_t>(revolutions, 2), MAX_REVOLUTIONS))
+    , m_mode(mode)
+    , m_required(2)
+    , m_threshold(128)
+{
+    m_history.assign(spokes * m_revolutions * max_spoke_len, 0);
+    m_next.assign(spokes, 0);
+    m_filled.assign(spokes, 0);
+    m_range.assign(spokes, 0);
+}
+
+void ScanIntegrator::SetRequired(size_t required) {
+    m_required = std::min(std::max<size_t>(required, 1), m_revolutions);
+}
+
+void ScanIntegrator::Process(const SpokeData* spokes, size_t count, std::vector<SpokeData>& out) {
+    out.clear();
+    m_rows.resize(count * m_max_spoke_len);
+
+    for (size_t i = 0; i < count; i++) {
+        const SpokeData& spoke = spokes[i];
+        if (spoke.angle >= m_spokes) continue;
+
+        // Revolutions at another range don't line up with this one
+        uint32_t angle = spoke.angle;
+        if (spoke.rangeMeters != m_range[angle]) {
+            m_range[angle] = spoke.rangeMeters;
+            m_filled[angle] = 0;
+            m_next[angle] = 0;
+        }
+
+        // Store this revolution over the oldest, padded with zeros
+        uint8_t* history = &m_history[angle * m_revolutions * m_max_spoke_len];
+        size_t current = m_next[angle];
+        size_t len = std::min(spoke.length, m_max_spoke_len);
+        uint8_t* row = history + current * m_max_spoke_len;
+        std::memcpy(row, spoke.data, len);
+        std::memset(row + len, 0, m_max_spoke_len - len);
+        m_next[angle] = (uint8_t)((current + 1) % m_revolutions);
+        m_filled[angle] = (uint8_t)std::min<size_t>(m_filled[angle] + 1, m_revolutions);
+
+        // Rows fill from 0 after a restart, so the first m_filled are valid
+        uint8_t* dst = &m_rows[out.size() * m_max_spoke_len];
+        Integrate(history, m_filled[angle], current, len, dst);
+
+        SpokeData integrated = spoke;
+        integrated.data = dst;
+        integrated.length = len;
+        out.push_back(integrated);
+    }
+}
+
+void ScanIntegrator::Integrate(const uint8_t* history, size_t rows, size_t current,
+                               size_t len, uint8_t* dst) const {
+    const size_t stride = m_max_spoke_len;
+    size_t i = 0;
+
+    switch (m_mode) {
+        case IntegrationMode::Min: {
+#if defined(MAYARA_SSE2)
+            for (; i + 16 <= len; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(history + i));
+                for (size_t r = 1; r < rows; r++) {
+                    v = _mm_min_epu8(v, _mm_loadu_si128((const __m128i*)(history + r * stride + i)));
+                }
+                _mm_storeu_si128((__m128i*)(dst + i), v);
+            }
+#elif defined(MAYARA_NEON)
+            for (; i + 16 <= len; i += 16) {
+                uint8x16_t v = vld1q_u8(history + i);
+                for (size_t r = 1; r < rows; r++) {
+                    v = vminq_u8(v, vld1q_u8(history + r * stride + i));
+                }
+                vst1q_u8(dst + i, v);
+            }
+#endif
+            for (; i < len; i++) {
+                uint8_t v = history[i];
+                for (size_t r = 1; r < rows; r++) {
+                    v = std::min(v, history[r * stride + i]);
+                }
+                dst[i] = v;
+            }
+            break;
+        }
+
+        case IntegrationMode::Mean: {
+            // Sums of up to 8 rows fit 16 bits; divide by multiplying with
+            // a rounded up 0.16 fixed point reciprocal
+            uint16_t recip = (uint16_t)((65536 + rows - 1) / rows);
+            if (rows == 1) {
+                std::memcpy(dst, history, len);
+                break;
+            }
+#if defined(MAYARA_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i r16 = _mm_set1_epi16((short)recip);
+            for (; i + 16 <= len; i += 16) {
+                __m128i lo = _mm_setzero_si128();
+                __m128i hi = _mm_setzero_si128();
+                for (size_t r = 0; r < rows; r++) {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(history + r * stride + i));
+                    lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+                    hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+                }
+                _mm_storeu_si128((__m128i*)(dst + i),
+                                 _mm_packus_epi16(_mm_mulhi_epu16(lo, r16), _mm_mulhi_epu16(hi, r16)));
+            }
+#elif defined(MAYARA_NEON)
+            const uint16x4_t r16 = vdup_n_u16(recip);
+            for (; i + 16 <= len; i += 16) {
+                uint16x8_t lo = vdupq_n_u16(0);
+                uint16x8_t hi = vdupq_n_u16(0);
+                for (size_t r = 0; r < rows; r++) {
+                    uint8x16_t v = vld1q_u8(history + r * stride + i);
+                    lo = vaddw_u8(lo, vget_low_u8(v));
+                    hi = vaddw_u8(hi, vget_high_u8(v));
+                }
+                uint16x8_t qlo = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(lo), r16), 16),
+                                              vshrn_n_u32(vmull_u16(vget_high_u16(lo), r16), 16));
+                uint16x8_t qhi = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(hi), r16), 16),
+                                              vshrn_n_u32(vmull_u16(vget_high_u16(hi), r16), 16));
+                vst1q_u8(dst + i, vcombine_u8(vqmovn_u16(qlo), vqmovn_u16(qhi)));
+            }
+#endif
+            for (; i < len; i++) {
+                uint32_t sum = 0;
+                for (size_t r = 0; r < rows; r++) {
+                    sum += history[r * stride + i];
+                }
+                dst[i] = (uint8_t)std::min<uint32_t>((sum * recip) >> 16, 255);
+            }
+            break;
+        }
+
+        case IntegrationMode::MofN: {
+            // Count hits per sample, keep the current sample where there
+            // are enough of them. Until M revolutions are in, the spoke is
+            // passed through rather than blanked.
+            const uint8_t* now = history + current * stride;
+            if (rows < m_required) {
+                std::memcpy(dst, now, len);
+                break;
+            }
+#if defined(MAYARA_SSE2)
+            // v >= threshold exactly when max(v, threshold) == v; a true
+            // compare is -1, so subtracting it counts
+            const __m128i threshold = _mm_set1_epi8((char)m_threshold);
+            const __m128i needed = _mm_set1_epi8((char)(m_required - 1));
+            for (; i + 16 <= len; i += 16) {
+                __m128i hits = _mm_setzero_si128();
+                for (size_t r = 0; r < rows; r++) {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(history + r * stride + i));
+                    hits = _mm_sub_epi8(hits, _mm_cmpeq_epi8(_mm_max_epu8(v, threshold), v));
+                }
+                __m128i keep = _mm_cmpgt_epi8(hits, needed);
+                _mm_storeu_si128((__m128i*)(dst + i),
+                                 _mm_and_si128(keep, _mm_loadu_si128((const __m128i*)(now + i))));
+            }
+#elif defined(MAYARA_NEON)
+            const uint8x16_t threshold = vdupq_n_u8(m_threshold);
+            const uint8x16_t needed = vdupq_n_u8((uint8_t)m_required);
+            const uint8x16_t one = vdupq_n_u8(1);
+            for (; i + 16 <= len; i += 16) {
+                uint8x16_t hits = vdupq_n_u8(0);
+                for (size_t r = 0; r < rows; r++) {
+                    uint8x16_t hit = vcgeq_u8(vld1q_u8(history + r * stride + i), threshold);
+                    hits = vaddq_u8(hits, vandq_u8(hit, one));
+                }
+                uint8x16_t keep = vcgeq_u8(hits, needed);
+                vst1q_u8(dst + i, vandq_u8(keep, vld1q_u8(now + i)));
+            }
+#endif
+            for (; i < len; i++) {
+                size_t hits = 0;
+                for (size_t r = 0; r < rows; r++) {
+                    hits += history[r * stride + i] >= m_threshold;
+                }
+                dst[i] = hits >= m_required ? now[i] : 0;
+            }
+            break;
+        }
+    }
+}
@@ -7,21 +7,60 @@
  */
 
 #include "SpokeBuffer.h"
+#include "simd.h"
+#include <atomic>
 #include <cstring>
 
 using namespace mayara;
 
-SpokeBuffer::SpokeBuffer(size_t spokes, size_t max_spoke_len)
+// Queue depth between ingest and render thread, as a fraction of a
+// revolution. Half a revolution is over a second at 24 RPM, far longer
+// than the render thread ever takes between paints.
+static size_t RingCapacity(size_t spokes) {
+    return std::max<size_t>(spokes / 2, 64);
+}
+
+Sweep::Sweep(size_t spokes, size_t spoke_len)
+    : revolution(0)
+    , spokes(spokes)
+    , spokeLen(spoke_len)
+    , gridRange(0)
+    , startTime(0)
+    , endTime(0)
+    , received(0)
+    , data(spokes * spoke_len, 0)
+    , valid(spokes, 0)
+{
+}
+
+SpokeBuffer::SpokeBuffer(size_t spokes, size_t max_spoke_len, bool packed)
     : m_spokes(spokes)
     , m_max_spoke_len(max_spoke_len)
+    , m_packed(packed)
+    , m_row_bytes(packed ? (max_spoke_len + 1) / 2 : max_spoke_len)
+    , m_ring(RingCapacity(spokes), m_row_bytes)
+    , m_queue_range(0)
+    , m_sweeps_enabled(false)
+    , m_last_angle(0)
+    , m_revolutions(0)
+    , m_grid_range(0)
+    , m_time_epoch(0)
+    , m_epoch_sequence(0)
+    , m_sequence(0)
 {
-    // Allocate texture data (RGBA per pixel)
-    m_texture_data.resize(spokes * max_spoke_len, 0);
+    // Allocate texture data (one byte per pixel, or per two when packed)
+    m_texture_data.resize(spokes * m_row_bytes, 0);
+    if (packed) {
+        m_pack_row.resize(max_spoke_len, 0);
+    }
 
     // Allocate metadata
     m_spoke_lengths.resize(spokes, 0);
     m_spoke_ranges.resize(spokes, 0);
-    m_timestamps.resize(spokes, 0);
+    m_spoke_times.resize(spokes, NO_TIME);
+
+    // Dirty tracking
+    m_journal.resize(spokes, 0);
 }
 
 SpokeBuffer::~SpokeBuffer() {
@@ -30,59 +69,386 @@ SpokeBuffer::~SpokeBuffer() {
 void SpokeBuffer::WriteSpoke(uint32_t angle, const uint8_t* data, size_t len, uint32_t range_meters) {
     if (angle >= m_spokes) return;
 
-    wxCriticalSectionLocker lock(m_lock);
+    QueueSpoke(angle, data, len, range_meters, wxGetLocalTimeMillis().GetValue());
+}
+
+void SpokeBuffer::WriteSpokes(const SpokeData* spokes, size_t count) {
+    if (!spokes || count == 0) return;
+
+    // Wall clock, only read if a spoke has no time of its own
+    uint64_t now = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const SpokeData& spoke = spokes[i];
+        if (spoke.angle >= m_spokes) continue;
+
+        uint64_t time = spoke.timestamp;
+        if (time == 0) {
+            if (now == 0) now = wxGetLocalTimeMillis().GetValue();
+            time = now;
+        }
+        QueueSpoke(spoke.angle, spoke.data, spoke.length, spoke.rangeMeters, time);
+    }
+}
+
+void SpokeBuffer::QueueSpoke(uint32_t angle, const uint8_t* data, size_t len,
+                             uint32_t range_meters, uint64_t now) {
+    // If the render thread is a full ring behind the spoke is dropped
+    // for display, but still counts for the sweep
+    SpokeSlot* slot = m_ring.BeginWrite();
+    if (!slot && !m_sweeps_enabled) return;
+
+    // The grid follows the radar range; a spoke without a range keeps
+    // the current grid and is copied as is
+    if (range_meters != 0) {
+        m_queue_range = range_meters;
+    }
+
+    // Packed rows are built unpacked first, then packed into the slot
+    uint8_t* row = (m_packed || !slot) ? m_pack_row.data() : slot->data;
+
+    size_t copy_len;
+    if (range_meters != 0 && len > 0) {
+        copy_len = m_resampler.Resample(data, len, range_meters,
+                                        row, m_max_spoke_len, m_queue_range);
+    } else {
+        // Copy data (truncate if too long)
+        copy_len = std::min(len, m_max_spoke_len);
+        if (copy_len > 0) {
+            std::memcpy(row, data, copy_len);
+        }
+
+        // Zero remaining if shorter
+        if (copy_len < m_max_spoke_len) {
+            std::memset(row + copy_len, 0, m_max_spoke_len - copy_len);
+        }
+    }
+
+    if (m_sweeps_enabled) {
+        AddToSweep(angle, row, now);
+    }
+    if (!slot) return;
+
+    if (m_packed) {
+        PackNibbles(row, m_max_spoke_len, slot->data);
+    }
+
+    slot->angle = angle;
+    slot->rangeMeters = range_meters;
+    slot->gridRange = m_queue_range;
+    slot->timestamp = now;
+    slot->length = (uint32_t)copy_len;
+
+    m_ring.CommitWrite();
+}
+
+void SpokeBuffer::SetSweepsEnabled(bool enabled) {
+    m_sweeps_enabled = enabled;
+    if (enabled && !m_building) {
+        m_building = std::make_shared<Sweep>(m_spokes, m_max_spoke_len);
+        m_pack_row.resize(m_max_spoke_len, 0);
+    } else if (!enabled) {
+        m_building.reset();
+    }
+}
+
+void SpokeBuffer::AddToSweep(uint32_t angle, const uint8_t* row, uint64_t time) {
+    Sweep* sweep = m_building.get();
+
+    // The angle jumping back by more than half a revolution means we
+    // passed the bow: the revolution is complete
+    if (sweep->received > 0 && angle < m_last_angle && m_last_angle - angle > m_spokes / 2) {
+        PublishSweep();
+        sweep = m_building.get();
+    }
+    m_last_angle = angle;
+
+    // A sweep is all on one grid; after a range change start over
+    if (sweep->gridRange != m_queue_range) {
+        RestartSweep();
+        sweep->gridRange = m_queue_range;
+    }
+
+    std::memcpy(&sweep->data[angle * m_max_spoke_len], row, m_max_spoke_len);
+    if (!sweep->valid[angle]) {
+        sweep->valid[angle] = 1;
+        sweep->received++;
+    }
+    if (sweep->startTime == 0) sweep->startTime = time;
+    sweep->endTime = time;
+}
+
+void SpokeBuffer::PublishSweep() {
+    m_building->revolution = m_revolutions.load(std::memory_order_relaxed) + 1;
+    uint32_t grid_range = m_building->gridRange;
+
+    std::shared_ptr<const Sweep> previous =
+        std::atomic_exchange(&m_last_sweep, std::shared_ptr<const Sweep>(m_building));
+    m_revolutions.store(m_building->revolution, std::memory_order_release);
+
+    // Build the next revolution in the previous sweep's memory, unless a
+    // consumer still holds it. use_count() is a relaxed load; the fence
+    // pairs it with the release of the last consumer's reference so its
+    // reads of the sweep happen before we overwrite it.
+    if (previous && previous.use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        m_building = std::const_pointer_cast<Sweep>(previous);
+    } else {
+        m_building = std::make_shared<Sweep>(m_spokes, m_max_spoke_len);
+    }
+    RestartSweep();
+    m_building->gridRange = grid_range;
+}
+
+void SpokeBuffer::RestartSweep() {
+    Sweep* sweep = m_building.get();
+    std::fill(sweep->valid.begin(), sweep->valid.end(), 0);
+    sweep->received = 0;
+    sweep->startTime = 0;
+    sweep->endTime = 0;
+}
+
+size_t SpokeBuffer::Drain() {
+    size_t count = 0;
 
-    // Calculate offset in texture
-    size_t offset = angle * m_max_spoke_len;
+    while (const SpokeSlot* slot = m_ring.BeginRead()) {
+        uint32_t angle = slot->angle;
 
-    // Copy data (truncate if too long)
-    size_t copy_len = std::min(len, m_max_spoke_len);
-    std::memcpy(&m_texture_data[offset], data, copy_len);
+        // First spoke at a new range: bring the rest of the revolution to
+        // the same scale before storing it
+        if (slot->gridRange != 0 && slot->gridRange != m_grid_range) {
+            RescaleRows(slot->gridRange);
+        }
 
-    // Zero remaining if shorter
-    if (copy_len < m_max_spoke_len) {
-        std::memset(&m_texture_data[offset + copy_len], 0, m_max_spoke_len - copy_len);
+        std::memcpy(&m_texture_data[angle * m_row_bytes], slot->data, m_row_bytes);
+
+        // New epoch once per revolution, and whenever a time would not
+        // fit (clock jumps, or a first spoke)
+        int64_t time = (int64_t)(slot->timestamp - m_time_epoch);
+        if (m_time_epoch == 0 || m_sequence - m_epoch_sequence >= m_spokes ||
+            time <= NO_TIME || time > INT32_MAX) {
+            SetTimeEpoch(slot->timestamp);
+            time = 0;
+        }
+
+        m_spoke_lengths[angle] = (uint16_t)slot->length;
+        m_spoke_ranges[angle] = slot->rangeMeters;
+        m_spoke_times[angle] = (int32_t)time;
+
+        m_journal[m_sequence % m_spokes] = angle;
+        m_sequence++;
+
+        m_ring.EndRead();
+        count++;
+    }
+
+    return count;
+}
+
+void SpokeBuffer::RescaleRows(uint32_t grid_range) {
+    // Nothing stored at a known scale yet
+    if (m_grid_range != 0) {
+        m_rescale_row.resize(m_max_spoke_len);
+        m_rescale_out.resize(m_max_spoke_len);
+        for (size_t angle = 0; angle < m_spokes; angle++) {
+            uint8_t* row = &m_texture_data[angle * m_row_bytes];
+            if (m_packed) {
+                UnpackNibbles(row, m_max_spoke_len, m_rescale_row.data());
+            } else {
+                std::memcpy(m_rescale_row.data(), row, m_max_spoke_len);
+            }
+            m_spoke_lengths[angle] = (uint16_t)m_rescaler.Resample(
+                m_rescale_row.data(), m_max_spoke_len, m_grid_range,
+                m_rescale_out.data(), m_max_spoke_len, grid_range);
+            if (m_packed) {
+                PackNibbles(m_rescale_out.data(), m_max_spoke_len, row);
+            } else {
+                std::memcpy(row, m_rescale_out.data(), m_max_spoke_len);
+            }
+        }
+
+        // Every row changed
+        m_sequence += m_spokes;
+    }
+
+    m_grid_range = grid_range;
+}
+
+void SpokeBuffer::SetTimeEpoch(uint64_t epoch) {
+    // Shift the stored times by the difference, saturating rather than
+    // wrapping for spokes that have not been refreshed in a long time
+    if (m_time_epoch != 0) {
+        int64_t delta = (int64_t)(m_time_epoch - epoch);
+        for (int32_t& time : m_spoke_times) {
+            if (time == NO_TIME) continue;
+            time = (int32_t)std::min<int64_t>(std::max<int64_t>(time + delta, NO_TIME + 1), INT32_MAX);
+        }
+    }
+
+    m_time_epoch = epoch;
+    m_epoch_sequence = m_sequence;
+}
+
+void SpokeBuffer::GetDirtySector(uint64_t since, std::vector<DirtyRun>& runs) const {
+    runs.clear();
+
+    uint64_t written = m_sequence - since;
+    if (written == 0) return;
+
+    // A revolution or more: everything changed, and the journal has
+    // already wrapped past 'since'
+    int64_t spokes = (int64_t)m_spokes;
+    if (written >= m_spokes) {
+        runs.push_back(DirtyRun{0, (uint32_t)m_spokes});
+        return;
+    }
+
+    // Follow the sweep from the first spoke written, taking the short way
+    // round between consecutive spokes, so both forward and backward
+    // rotation and slightly out of order spokes give a tight arc
+    uint32_t start = m_journal[since % m_spokes];
+    uint32_t prev = start;
+    int64_t pos = 0, lo = 0, hi = 0;
+    for (uint64_t seq = since + 1; seq < m_sequence; seq++) {
+        uint32_t angle = m_journal[seq % m_spokes];
+        int64_t step = ((int64_t)angle - prev + spokes) % spokes;
+        if (step > spokes / 2) step -= spokes;
+        pos += step;
+        lo = std::min(lo, pos);
+        hi = std::max(hi, pos);
+        prev = angle;
     }
 
-    // Update metadata
-    m_spoke_lengths[angle] = copy_len;
-    m_spoke_ranges[angle] = range_meters;
-    m_timestamps[angle] = wxGetLocalTimeMillis();
+    int64_t count = hi - lo + 1;
+    if (count >= spokes) {
+        runs.push_back(DirtyRun{0, (uint32_t)m_spokes});
+        return;
+    }
+
+    // Split at angle 0
+    uint32_t first = (uint32_t)(((int64_t)start + lo % spokes + spokes) % spokes);
+    if ((size_t)(first + count) <= m_spokes) {
+        runs.push_back(DirtyRun{first, (uint32_t)count});
+    } else {
+        uint32_t head = (uint32_t)(m_spokes - first);
+        runs.push_back(DirtyRun{first, head});
+        runs.push_back(DirtyRun{0, (uint32_t)count - head});
+    }
 }
 
 const uint8_t* SpokeBuffer::GetSpoke(uint32_t angle) const {
     if (angle >= m_spokes) return nullptr;
 
-    wxCriticalSectionLocker lock(m_lock);
-    return &m_texture_data[angle * m_max_spoke_len];
+    return &m_texture_data[angle * m_row_bytes];
+}
+
+bool SpokeBuffer::ReadSpoke(uint32_t angle, uint8_t* dst) const {
+    if (angle >= m_spokes) return false;
+
+    const uint8_t* row = &m_texture_data[angle * m_row_bytes];
+    if (m_packed) {
+        UnpackNibbles(row, m_max_spoke_len, dst);
+    } else {
+        std::memcpy(dst, row, m_max_spoke_len);
+    }
+    return true;
 }
 
 size_t SpokeBuffer::GetSpokeLength(uint32_t angle) const {
     if (angle >= m_spokes) return 0;
 
-    wxCriticalSectionLocker lock(m_lock);
     return m_spoke_lengths[angle];
 }
 
 uint32_t SpokeBuffer::GetSpokeRange(uint32_t angle) const {
     if (angle >= m_spokes) return 0;
 
-    wxCriticalSectionLocker lock(m_lock);
     return m_spoke_ranges[angle];
 }
 
 wxLongLong SpokeBuffer::GetSpokeTime(uint32_t angle) const {
-    if (angle >= m_spokes) return 0;
+    if (angle >= m_spokes || m_spoke_times[angle] == NO_TIME) return 0;
 
-    wxCriticalSectionLocker lock(m_lock);
-    return m_timestamps[angle];
+    return wxLongLong(m_time_epoch + m_spoke_times[angle]);
 }
 
 void SpokeBuffer::Clear() {
-    wxCriticalSectionLocker lock(m_lock);
+    // Discard anything still in flight
+    while (m_ring.BeginRead()) {
+        m_ring.EndRead();
+    }
 
     std::memset(m_texture_data.data(), 0, m_texture_data.size());
     std::fill(m_spoke_lengths.begin(), m_spoke_lengths.end(), 0);
     std::fill(m_spoke_ranges.begin(), m_spoke_ranges.end(), 0);
-    std::fill(m_timestamps.begin(), m_timestamps.end(), 0);
+    std::fill(m_spoke_times.begin(), m_spoke_times.end(), NO_TIME);
+
+    // Every row changed
+    m_sequence += m_spokes;
+}
+
+void mayara::PackNibbles(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t i = 0;
+
+#if defined(MAYARA_SSE2)
+    // 32 samples to 16 bytes: as 16-bit lanes each pair is even | odd << 8,
+    // and (pair & 0xFF) | (pair >> 4) moves the odd nibble next to the even
+    const __m128i max = _mm_set1_epi8(15);
+    const __m128i low = _mm_set1_epi16(0x00FF);
+    for (; i + 32 <= len; i += 32) {
+        __m128i a = _mm_min_epu8(_mm_loadu_si128((const __m128i*)(src + i)), max);
+        __m128i b = _mm_min_epu8(_mm_loadu_si128((const __m128i*)(src + i + 16)), max);
+        a = _mm_or_si128(_mm_and_si128(a, low), _mm_srli_epi16(a, 4));
+        b = _mm_or_si128(_mm_and_si128(b, low), _mm_srli_epi16(b, 4));
+        _mm_storeu_si128((__m128i*)(dst + i / 2), _mm_packus_epi16(a, b));
+    }
+#elif defined(MAYARA_NEON)
+    const uint8x16_t max = vdupq_n_u8(15);
+    for (; i + 32 <= len; i += 32) {
+        uint8x16x2_t pairs = vld2q_u8(src + i);
+        uint8x16_t even = vminq_u8(pairs.val[0], max);
+        uint8x16_t odd = vminq_u8(pairs.val[1], max);
+        vst1q_u8(dst + i / 2, vorrq_u8(even, vshlq_n_u8(odd, 4)));
+    }
+#endif
+
+    for (; i + 2 <= len; i += 2) {
+        dst[i / 2] = (uint8_t)(std::min<uint8_t>(src[i], 15) |
+                               (std::min<uint8_t>(src[i + 1], 15) << 4));
+    }
+    if (i < len) {
+        dst[i / 2] = std::min<uint8_t>(src[i], 15);
+    }
+}
+
+void mayara::UnpackNibbles(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t i = 0;
+
+#if defined(MAYARA_SSE2)
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    for (; i + 32 <= len; i += 32) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i / 2));
+        __m128i even = _mm_and_si128(v, mask);
+        __m128i odd = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(even, odd));
+        _mm_storeu_si128((__m128i*)(dst + i + 16), _mm_unpackhi_epi8(even, odd));
+    }
+#elif defined(MAYARA_NEON)
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+    for (; i + 32 <= len; i += 32) {
+        uint8x16_t v = vld1q_u8(src + i / 2);
+        uint8x16x2_t pairs;
+        pairs.val[0] = vandq_u8(v, mask);
+        pairs.val[1] = vshrq_n_u8(v, 4);
+        vst2q_u8(dst + i, pairs);
+    }
+#endif
+
+    for (; i + 2 <= len; i += 2) {
+        dst[i] = src[i / 2] & 0x0F;
+        dst[i + 1] = src[i / 2] >> 4;
+    }
+    if (i < len) {
+        dst[i] = src[i / 2] & 0x0F;
+    }
 }
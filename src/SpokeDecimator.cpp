@@ -0,0 +1,183 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Merges adjacent spokes to reduce angular resolution
+ */
+
+#include "SpokeDecimator.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace mayara;
+
+SpokeDecimator::SpokeDecimator(size_t spokes, size_t factor, size_t max_spoke_len,
+                               DecimationMode mode)
+    : m_spokes(spokes)
+    , m_factor(factor)
+    , m_max_spoke_len(max_spoke_len)
+    , m_mode(mode)
+    , m_bin(-1)
+    , m_count(0)
+    , m_length(0)
+    , m_meta()
+{
+    m_sum.assign(max_spoke_len, 0);
+    m_max.assign(max_spoke_len, 0);
+    if (mode == DecimationMode::PeakHold) {
+        m_hold.assign(GetOutputSpokes() * max_spoke_len, 0);
+    }
+}
+
+void SpokeDecimator::Process(const SpokeData* spokes, size_t count, std::vector<SpokeData>& out) {
+    m_pending.clear();
+    m_rows.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        const SpokeData& spoke = spokes[i];
+        if (spoke.angle >= m_spokes) continue;
+
+        // A spoke from another group, or at another range, ends the group
+        int64_t bin = spoke.angle / m_factor;
+        if (m_bin >= 0 && (bin != m_bin || spoke.rangeMeters != m_meta.rangeMeters)) {
+            Flush();
+        }
+        m_bin = bin;
+
+        Accumulate(spoke);
+        if (m_count == m_factor) {
+            Flush();
+        }
+    }
+
+    // Rows may have moved while m_rows grew, point at them only now
+    out.assign(m_pending.begin(), m_pending.end());
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i].data = m_rows.data() + i * m_max_spoke_len;
+    }
+}
+
+void SpokeDecimator::Accumulate(const SpokeData& spoke) {
+    size_t len = std::min(spoke.length, m_max_spoke_len);
+    const uint8_t* src = spoke.data;
+    size_t i = 0;
+
+    if (m_mode == DecimationMode::Mean) {
+        uint16_t* sum = m_sum.data();
+#if defined(MAYARA_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i lo = _mm_loadu_si128((const __m128i*)(sum + i));
+            __m128i hi = _mm_loadu_si128((const __m128i*)(sum + i + 8));
+            _mm_storeu_si128((__m128i*)(sum + i), _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero)));
+            _mm_storeu_si128((__m128i*)(sum + i + 8), _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero)));
+        }
+#elif defined(MAYARA_NEON)
+        for (; i + 16 <= len; i += 16) {
+            uint8x16_t v = vld1q_u8(src + i);
+            vst1q_u16(sum + i, vaddw_u8(vld1q_u16(sum + i), vget_low_u8(v)));
+            vst1q_u16(sum + i + 8, vaddw_u8(vld1q_u16(sum + i + 8), vget_high_u8(v)));
+        }
+#endif
+        for (; i < len; i++) {
+            sum[i] += src[i];
+        }
+    } else {
+        uint8_t* max = m_max.data();
+#if defined(MAYARA_SSE2)
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i m = _mm_loadu_si128((const __m128i*)(max + i));
+            _mm_storeu_si128((__m128i*)(max + i), _mm_max_epu8(v, m));
+        }
+#elif defined(MAYARA_NEON)
+        for (; i + 16 <= len; i += 16) {
+            vst1q_u8(max + i, vmaxq_u8(vld1q_u8(src + i), vld1q_u8(max + i)));
+        }
+#endif
+        for (; i < len; i++) {
+            max[i] = std::max(max[i], src[i]);
+        }
+    }
+
+    m_meta = spoke;
+    m_length = std::max(m_length, len);
+    m_count++;
+}
+
+void SpokeDecimator::Flush() {
+    if (m_bin < 0 || m_count == 0) return;
+
+    size_t offset = m_rows.size();
+    m_rows.resize(offset + m_max_spoke_len);
+    uint8_t* dst = &m_rows[offset];
+    size_t len = m_length;
+
+    switch (m_mode) {
+        case DecimationMode::Mean: {
+            // Divide by the spokes actually received, which is less than
+            // the factor if some were lost
+            uint16_t* sum = m_sum.data();
+            size_t i = 0;
+            if (m_count == 1) {
+                for (; i < len; i++) dst[i] = (uint8_t)sum[i];
+            } else {
+                uint16_t recip = (uint16_t)((65536 + m_count - 1) / m_count);
+#if defined(MAYARA_SSE2)
+                const __m128i r = _mm_set1_epi16((short)recip);
+                for (; i + 16 <= len; i += 16) {
+                    __m128i lo = _mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(sum + i)), r);
+                    __m128i hi = _mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(sum + i + 8)), r);
+                    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+                }
+#elif defined(MAYARA_NEON)
+                const uint16x4_t r = vdup_n_u16(recip);
+                for (; i + 8 <= len; i += 8) {
+                    uint16x8_t s = vld1q_u16(sum + i);
+                    uint32x4_t lo = vmull_u16(vget_low_u16(s), r);
+                    uint32x4_t hi = vmull_u16(vget_high_u16(s), r);
+                    uint16x8_t q = vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+                    vst1_u8(dst + i, vqmovn_u16(q));
+                }
+#endif
+                for (; i < len; i++) {
+                    dst[i] = (uint8_t)std::min<uint32_t>(((uint32_t)sum[i] * recip) >> 16, 255);
+                }
+            }
+            break;
+        }
+
+        case DecimationMode::Max:
+            std::memcpy(dst, m_max.data(), len);
+            break;
+
+        case DecimationMode::PeakHold: {
+            // New peaks show at once, old ones fade by 1/8 per revolution
+            uint8_t* hold = &m_hold[m_bin * m_max_spoke_len];
+            for (size_t i = 0; i < m_max_spoke_len; i++) {
+                uint8_t faded = hold[i] - (hold[i] >> 3);
+                hold[i] = std::max(i < len ? m_max[i] : (uint8_t)0, faded);
+            }
+            std::memcpy(dst, hold, m_max_spoke_len);
+            len = m_max_spoke_len;
+            break;
+        }
+    }
+
+    SpokeData merged = m_meta;
+    merged.angle = (uint32_t)m_bin;
+    merged.bearing = m_meta.bearing / m_factor;
+    merged.data = nullptr;  // Set once all rows of this call are in place
+    merged.length = len;
+    m_pending.push_back(merged);
+
+    // Reset for the next group
+    std::fill(m_sum.begin(), m_sum.begin() + m_length, 0);
+    std::fill(m_max.begin(), m_max.begin() + m_length, 0);
+    m_bin = -1;
+    m_count = 0;
+    m_length = 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Per-radar worker thread that decodes and processes spoke frames
+ */
+
+#include "SpokeIngest.h"
+#include <chrono>
+
+using namespace mayara;
+
+// Spokes per frame the buffers are sized for up front. Larger frames
+// still work, they grow a buffer once.
+static const size_t SPOKES_PER_FRAME = 32;
+
+SpokeIngest::SpokeIngest(SpokeBatchCallback callback,
+                         size_t max_spoke_len,
+                         size_t queue_frames)
+    : m_callback(callback)
+    , m_queue(queue_frames)
+    // Enough for a full queue plus the frame being decoded and the one
+    // being filled, so the socket thread never runs out
+    , m_pool(m_queue.GetCapacity() + 2,
+             FramePool::FrameCapacity(SPOKES_PER_FRAME, max_spoke_len))
+    , m_running(false)
+    , m_frames_processed(0)
+    , m_frames_unqueued(0)
+    , m_spokes_received(0)
+    , m_decode_errors(0)
+{
+}
+
+SpokeIngest::~SpokeIngest() {
+    Stop();
+}
+
+void SpokeIngest::Start() {
+    if (m_thread.joinable()) return;
+
+    m_running = true;
+    m_thread = std::thread([this]() { Run(); });
+}
+
+void SpokeIngest::Stop() {
+    if (!m_thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wake_lock);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // Frames left in the queue would be stale on the next Start()
+    while (Frame* frame = m_queue.Pop()) {
+        m_pool.Release(frame);
+    }
+}
+
+void SpokeIngest::Submit(const uint8_t* data, size_t len) {
+    Frame* frame = m_pool.Acquire();
+    if (!frame) {
+        // Only possible with more than one thread submitting
+        m_frames_unqueued++;
+        return;
+    }
+
+    m_pool.Fill(frame, data, len);
+    m_pool.Release(m_queue.Push(frame));
+
+    // Taking the lock orders us against the worker's empty check, so the
+    // wakeup can't be lost. The worker only holds it for that check.
+    { std::lock_guard<std::mutex> lock(m_wake_lock); }
+    m_wake.notify_one();
+}
+
+void SpokeIngest::Run() {
+    while (m_running.load()) {
+        if (Frame* frame = m_queue.Pop()) {
+            Process(frame);
+            m_pool.Release(frame);
+            m_frames_processed++;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wake_lock);
+        m_wake.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+            return !m_running.load() || !m_queue.IsEmpty();
+        });
+    }
+}
+
+void SpokeIngest::Process(const Frame* frame) {
+    // Decode in place - spoke.data points into 'frame', nothing is copied
+    RadarMessageReader reader(frame->data.data(), frame->length);
+
+    // m_batch keeps its capacity, so this only allocates until it has
+    // grown to the largest frame seen
+    m_batch.clear();
+    SpokeData spoke;
+    while (reader.Next(spoke)) {
+        m_batch.push_back(spoke);
+    }
+
+    if (reader.HasError()) {
+        m_decode_errors++;
+    }
+    m_spokes_received += m_batch.size();
+
+    // One dispatch for the whole frame
+    if (m_callback && !m_batch.empty()) {
+        m_callback(m_batch.data(), m_batch.size());
+    }
+}
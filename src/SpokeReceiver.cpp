@@ -15,14 +15,14 @@
 using namespace mayara;
 
 SpokeReceiver::SpokeReceiver(const std::string& url,
-                             SpokeCallback callback,
+                             FrameCallback callback,
                              int reconnect_interval_ms)
     : m_callback(callback)
     , m_url(url)
     , m_reconnect_interval_ms(reconnect_interval_ms)
     , m_connected(false)
     , m_should_run(false)
-    , m_spokes_received(0)
+    , m_frames_received(0)
     , m_bytes_received(0)
 {
     wxLogMessage("MaYaRa: SpokeReceiver ctor - about to create WebSocket");
@@ -129,9 +129,11 @@ void SpokeReceiver::OnError(const std::string& error) {
 
 void SpokeReceiver::OnMessage(const std::string& data) {
     m_bytes_received += data.size();
+    m_frames_received++;
 
-    if (DecodeProtobuf(data)) {
-        m_spokes_received++;
+    // Hand the frame off at once, decoding runs on the ingest worker
+    if (m_callback) {
+        m_callback(reinterpret_cast<const uint8_t*>(data.data()), data.size());
     }
 }
 
@@ -142,28 +144,3 @@ void SpokeReceiver::ScheduleReconnect() {
         m_websocket->start();
     }
 }
-
-bool SpokeReceiver::DecodeProtobuf(const std::string& data) {
-    // TODO: Implement protobuf decoding
-    // For now, create a simple spoke from raw data
-
-    if (data.size() < 16) return false;  // Minimum header size
-
-    // Parse basic header (this is a placeholder - real implementation
-    // needs proper protobuf decoding)
-    SpokeData spoke;
-    spoke.angle = 0;
-    spoke.bearing = 0;
-    spoke.rangeMeters = 1000;
-    spoke.timestamp = wxGetLocalTimeMillis().GetValue();
-
-    // Copy data
-    spoke.data.assign(data.begin(), data.end());
-
-    // Call callback
-    if (m_callback) {
-        m_callback(spoke);
-    }
-
-    return true;
-}
@@ -0,0 +1,132 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Resamples spokes onto a fixed meters-per-sample grid
+ */
+
+#include "SpokeResampler.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace mayara;
+
+SpokeResampler::SpokeResampler()
+    : m_len(0)
+    , m_range(0)
+    , m_out_len(0)
+    , m_out_range(0)
+    , m_decimate(false)
+    , m_valid(0)
+    , m_window(1)
+    , m_pow2(1)
+{
+}
+
+void SpokeResampler::Prepare(size_t len, uint32_t range, size_t out_len, uint32_t out_range) {
+    if (len == m_len && range == m_range && out_len == m_out_len && out_range == m_out_range) {
+        return;
+    }
+    m_len = len;
+    m_range = range;
+    m_out_len = out_len;
+    m_out_range = out_range;
+
+    // Source samples per output sample
+    double step = ((double)out_range / out_len) / ((double)range / len);
+    m_decimate = step > 1.0;
+
+    m_valid = std::min(out_len, (size_t)floor(len / step));
+    m_index.resize(out_len);
+    m_weight.resize(out_len);
+
+    if (m_decimate) {
+        // Output j covers source [j * step, (j + 1) * step). Use one fixed
+        // window size so the running max can be computed for all
+        // positions at once; it may overlap the next output by a sample.
+        m_window = (size_t)ceil(step);
+        m_pow2 = 1;
+        while (m_pow2 * 2 <= m_window) m_pow2 *= 2;
+        for (size_t j = 0; j < m_valid; j++) {
+            m_index[j] = (uint32_t)std::min((size_t)(j * step), len - 1);
+        }
+        m_scratch.assign(len + 2 * m_window + 32, 0);
+    } else {
+        // Sample centers: output j sits at source position (j + 0.5) * step - 0.5
+        for (size_t j = 0; j < m_valid; j++) {
+            double pos = std::max((j + 0.5) * step - 0.5, 0.0);
+            size_t i = std::min((size_t)pos, len - 1);
+            m_index[j] = (uint32_t)i;
+            m_weight[j] = i + 1 < len ? (uint16_t)((pos - i) * 256.0 + 0.5) : 0;
+        }
+    }
+}
+
+void SpokeResampler::SlidingMax(const uint8_t* src, size_t len) {
+    // After the pass for p, m_scratch[i] is the max of src[i, i + 2p).
+    // Each pass is an in-place max of the buffer with itself shifted by p,
+    // which is safe in ascending order since i + p is read before it is
+    // written.
+    uint8_t* a = m_scratch.data();
+    std::memcpy(a, src, len);
+    std::memset(a + len, 0, m_scratch.size() - len);
+
+    size_t n = len + m_window;
+    for (size_t p = 1; p < m_pow2; p *= 2) {
+        size_t i = 0;
+#if defined(MAYARA_SSE2)
+        for (; i + 16 <= n; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(a + i + p));
+            _mm_storeu_si128((__m128i*)(a + i), _mm_max_epu8(x, y));
+        }
+#elif defined(MAYARA_NEON)
+        for (; i + 16 <= n; i += 16) {
+            vst1q_u8(a + i, vmaxq_u8(vld1q_u8(a + i), vld1q_u8(a + i + p)));
+        }
+#endif
+        for (; i < n; i++) {
+            a[i] = std::max(a[i], a[i + p]);
+        }
+    }
+}
+
+size_t SpokeResampler::Resample(const uint8_t* src, size_t len, uint32_t range,
+                                uint8_t* dst, size_t out_len, uint32_t out_range) {
+    if (out_len == 0) return 0;
+    if (len == 0 || range == 0 || out_range == 0) {
+        std::memset(dst, 0, out_len);
+        return 0;
+    }
+
+    // Same geometry, the common case
+    if (len == out_len && range == out_range) {
+        std::memcpy(dst, src, len);
+        return len;
+    }
+
+    Prepare(len, range, out_len, out_range);
+
+    if (m_decimate) {
+        SlidingMax(src, len);
+        const uint8_t* a = m_scratch.data();
+        size_t tail = m_window - m_pow2;
+        for (size_t j = 0; j < m_valid; j++) {
+            uint32_t i = m_index[j];
+            dst[j] = std::max(a[i], a[i + tail]);
+        }
+    } else {
+        for (size_t j = 0; j < m_valid; j++) {
+            uint32_t i = m_index[j];
+            uint32_t w = m_weight[j];
+            uint32_t next = w ? src[i + 1] : 0;
+            dst[j] = (uint8_t)((src[i] * (256 - w) + next * w + 128) >> 8);
+        }
+    }
+
+    std::memset(dst + m_valid, 0, out_len - m_valid);
+    return m_valid;
+}
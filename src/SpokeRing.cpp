@@ -0,0 +1,72 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Lock-free single-producer/single-consumer queue of spoke slots
+ */
+
+#include "SpokeRing.h"
+
+using namespace mayara;
+
+SpokeRing::SpokeRing(size_t capacity, size_t payload_len)
+    : m_payload_len(payload_len)
+    , m_head(0)
+    , m_cached_tail(0)
+    , m_tail(0)
+    , m_cached_head(0)
+    , m_dropped(0)
+{
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    m_mask = size - 1;
+
+    // Payloads live in one contiguous block, slots point into it
+    m_payload.resize(size * payload_len, 0);
+    m_slots.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        m_slots[i] = SpokeSlot{0, 0, 0, 0, 0, &m_payload[i * payload_len]};
+    }
+}
+
+SpokeRing::~SpokeRing() {
+}
+
+SpokeSlot* SpokeRing::BeginWrite() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+
+    // Only reload the consumer's tail when our cached copy says full
+    if (head - m_cached_tail > m_mask) {
+        m_cached_tail = m_tail.load(std::memory_order_acquire);
+        if (head - m_cached_tail > m_mask) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    return &m_slots[head & m_mask];
+}
+
+void SpokeRing::CommitWrite() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+const SpokeSlot* SpokeRing::BeginRead() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    if (tail == m_cached_head) {
+        m_cached_head = m_head.load(std::memory_order_acquire);
+        if (tail == m_cached_head) {
+            return nullptr;
+        }
+    }
+
+    return &m_slots[tail & m_mask];
+}
+
+void SpokeRing::EndRead() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_release);
+}
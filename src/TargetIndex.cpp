@@ -0,0 +1,178 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Uniform grid index over target positions
+ */
+
+#include "TargetIndex.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mayara;
+
+TargetIndex::TargetIndex()
+    : m_cell(1.0f)
+    , m_origin_x(0.0f)
+    , m_origin_y(0.0f)
+    , m_columns(1)
+    , m_rows(1)
+{
+    m_cell_start.assign(2, 0);
+}
+
+void TargetIndex::Build(const float* x, const float* y, size_t count, float cell) {
+    m_x.assign(x, x + count);
+    m_y.assign(y, y + count);
+
+    // Points that aren't finite keep their index but are left out of the
+    // grid, so no query finds them
+    auto finite = [&](size_t i) { return std::isfinite(x[i]) && std::isfinite(y[i]); };
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+    size_t indexed = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!finite(i)) continue;
+        if (indexed++ == 0) {
+            min_x = max_x = x[i];
+            min_y = max_y = y[i];
+        }
+        min_x = std::min(min_x, x[i]);
+        max_x = std::max(max_x, x[i]);
+        min_y = std::min(min_y, y[i]);
+        max_y = std::max(max_y, y[i]);
+    }
+
+    // Grow the cells if the points are spread so far apart that the grid
+    // would have many more cells than points
+    m_cell = std::max(cell, 1e-3f);
+    const double max_cells = 4.0 * indexed + 16.0;
+    while ((((double)max_x - min_x) / m_cell + 1.0) * (((double)max_y - min_y) / m_cell + 1.0) > max_cells) {
+        m_cell *= 2.0f;
+    }
+    m_origin_x = min_x;
+    m_origin_y = min_y;
+    m_columns = (int)(((double)max_x - min_x) / m_cell) + 1;
+    m_rows = (int)(((double)max_y - min_y) / m_cell) + 1;
+
+    // Counting sort by cell
+    const size_t cells = (size_t)m_columns * m_rows;
+    m_cell_start.assign(cells + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        if (finite(i)) m_cell_start[(size_t)CellY(y[i]) * m_columns + CellX(x[i]) + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        m_cell_start[c + 1] += m_cell_start[c];
+    }
+    m_points.resize(indexed);
+    std::vector<uint32_t> next(m_cell_start.begin(), m_cell_start.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (finite(i)) m_points[next[(size_t)CellY(y[i]) * m_columns + CellX(x[i])]++] = (uint32_t)i;
+    }
+}
+
+// Clamped to the grid; NaN goes to cell 0 rather than through an int cast
+int TargetIndex::CellX(float x) const {
+    float c = floorf((x - m_origin_x) / m_cell);
+    if (!(c > 0.0f)) return 0;
+    return (int)std::min(c, (float)(m_columns - 1));
+}
+
+int TargetIndex::CellY(float y) const {
+    float c = floorf((y - m_origin_y) / m_cell);
+    if (!(c > 0.0f)) return 0;
+    return (int)std::min(c, (float)(m_rows - 1));
+}
+
+template <typename F>
+void TargetIndex::ForEachInBox(float x0, float y0, float x1, float y1, F f) const {
+    // Every point is inside the grid, so clamping the box to it keeps
+    // all points that can be in the box
+    int cx1 = CellX(x1);
+    int cy1 = CellY(y1);
+    for (int cy = CellY(y0); cy <= cy1; cy++) {
+        for (int cx = CellX(x0); cx <= cx1; cx++) {
+            size_t c = (size_t)cy * m_columns + cx;
+            for (uint32_t k = m_cell_start[c]; k < m_cell_start[c + 1]; k++) {
+                f(m_points[k]);
+            }
+        }
+    }
+}
+
+int TargetIndex::Nearest(float x, float y, float max_distance) const {
+    int nearest = -1;
+    float nearest2 = max_distance * max_distance;
+    ForEachInBox(x - max_distance, y - max_distance, x + max_distance, y + max_distance,
+        [&](uint32_t i) {
+            float dx = m_x[i] - x;
+            float dy = m_y[i] - y;
+            float d2 = dx * dx + dy * dy;
+            if (d2 <= nearest2) {
+                nearest = (int)i;
+                nearest2 = d2;
+            }
+        });
+    return nearest;
+}
+
+void TargetIndex::PlaceLabels(const std::vector<uint32_t>& order, float w, float h,
+                              float gap, float symbol,
+                              std::vector<float>& left, std::vector<float>& top,
+                              std::vector<uint8_t>& shown) {
+    const size_t count = m_x.size();
+    left.assign(count, 0.0f);
+    top.assign(count, 0.0f);
+    shown.assign(count, 0);
+
+    m_label_cells.resize((size_t)m_columns * m_rows);
+    for (auto& cell : m_label_cells) cell.clear();
+
+    auto free = [&](uint32_t self, float x0, float y0) {
+        float x1 = x0 + w;
+        float y1 = y0 + h;
+
+        // Labels are all w x h, so one overlapping this box has its
+        // corner in [x0 - w, x1] x [y0 - h, y1]
+        int cx1 = CellX(x1);
+        int cy1 = CellY(y1);
+        for (int cy = CellY(y0 - h); cy <= cy1; cy++) {
+            for (int cx = CellX(x0 - w); cx <= cx1; cx++) {
+                for (uint32_t other : m_label_cells[(size_t)cy * m_columns + cx]) {
+                    if (left[other] < x1 && left[other] + w > x0 &&
+                        top[other] < y1 && top[other] + h > y0) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        bool covers = false;
+        ForEachInBox(x0 - symbol, y0 - symbol, x1 + symbol, y1 + symbol, [&](uint32_t i) {
+            if (i == self || covers) return;
+            float dx = m_x[i] - std::min(std::max(m_x[i], x0), x1);
+            float dy = m_y[i] - std::min(std::max(m_y[i], y0), y1);
+            covers = dx * dx + dy * dy < symbol * symbol;
+        });
+        return !covers;
+    };
+
+    for (uint32_t i : order) {
+        if (i >= count || !std::isfinite(m_x[i]) || !std::isfinite(m_y[i])) continue;
+        const float candidates[4][2] = {
+            { m_x[i] + gap, m_y[i] - h / 2 },          // Right
+            { m_x[i] - gap - w, m_y[i] - h / 2 },      // Left
+            { m_x[i] - w / 2, m_y[i] - gap - h },      // Above
+            { m_x[i] - w / 2, m_y[i] + gap },          // Below
+        };
+        for (const auto& candidate : candidates) {
+            if (free(i, candidate[0], candidate[1])) {
+                left[i] = candidate[0];
+                top[i] = candidate[1];
+                shown[i] = 1;
+                m_label_cells[(size_t)CellY(top[i]) * m_columns + CellX(left[i])].push_back(i);
+                break;
+            }
+        }
+    }
+}
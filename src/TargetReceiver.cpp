@@ -0,0 +1,169 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * WebSocket client for the ARPA target stream of mayara-server
+ */
+
+// Include wx headers first to get ssize_t defined before IXWebSocket
+#include "pi_common.h"
+
+#include "TargetReceiver.h"
+#include <ixwebsocket/IXWebSocket.h>
+#include <nlohmann/json.hpp>
+
+using namespace mayara;
+using json = nlohmann::json;
+
+// Fields as in MayaraClient::GetTargets(); missing ones are 0
+static ArpaTarget ParseTarget(const json& t) {
+    ArpaTarget target = {};
+    if (t.contains("targetId")) target.targetId = t["targetId"].get<int>();
+    if (t.contains("bearing")) target.bearing = t["bearing"].get<double>();
+    if (t.contains("distance")) target.distance = t["distance"].get<double>();
+    if (t.contains("speed")) target.speed = t["speed"].get<double>();
+    if (t.contains("course")) target.course = t["course"].get<double>();
+    if (t.contains("cpa")) target.cpa = t["cpa"].get<double>();
+    if (t.contains("tcpa")) target.tcpa = t["tcpa"].get<double>();
+    return target;
+}
+
+static bool IsLost(const json& t) {
+    for (const char* key : { "status", "type" }) {
+        if (t.contains(key) && t[key].is_string()) {
+            const std::string& value = t[key].get_ref<const std::string&>();
+            if (value == "lost" || value == "removed") return true;
+        }
+    }
+    return false;
+}
+
+TargetReceiver::TargetReceiver(const std::string& url, TargetTable* table)
+    : m_table(table)
+    , m_url(url)
+    , m_connected(false)
+    , m_should_run(false)
+    , m_messages_received(0)
+    , m_parse_errors(0)
+{
+}
+
+TargetReceiver::~TargetReceiver() {
+    Stop();
+}
+
+void TargetReceiver::Start() {
+    m_should_run = true;
+
+    if (!m_websocket) {
+        try {
+            m_websocket = std::make_unique<ix::WebSocket>();
+        } catch (const std::exception& e) {
+            wxLogMessage("MaYaRa: TargetReceiver WebSocket creation FAILED: %s", e.what());
+            return;
+        }
+    }
+
+    m_websocket->setUrl(m_url);
+    m_websocket->setOnMessageCallback(
+        [this](const ix::WebSocketMessagePtr& msg) {
+            switch (msg->type) {
+                case ix::WebSocketMessageType::Open:
+                    OnOpen();
+                    break;
+                case ix::WebSocketMessageType::Close:
+                    OnClose();
+                    break;
+                case ix::WebSocketMessageType::Error:
+                    OnError(msg->errorInfo.reason);
+                    break;
+                case ix::WebSocketMessageType::Message:
+                    if (!msg->binary) {
+                        m_messages_received++;
+                        if (!Apply(msg->str)) m_parse_errors++;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    );
+    m_websocket->start();
+}
+
+void TargetReceiver::Stop() {
+    m_should_run = false;
+    if (m_websocket) {
+        m_websocket->stop();
+    }
+    m_connected = false;
+}
+
+void TargetReceiver::OnOpen() {
+    m_connected = true;
+}
+
+void TargetReceiver::OnClose() {
+    m_connected = false;
+    m_table->Clear();
+    m_table->Publish();
+
+    if (m_should_run) {
+        ScheduleReconnect();
+    }
+}
+
+void TargetReceiver::OnError(const std::string& error) {
+    m_connected = false;
+    m_table->Clear();
+    m_table->Publish();
+
+    if (m_should_run) {
+        ScheduleReconnect();
+    }
+}
+
+void TargetReceiver::ScheduleReconnect() {
+    // IXWebSocket handles reconnection internally
+    // We just need to restart
+    if (m_should_run && !m_connected) {
+        m_websocket->start();
+    }
+}
+
+bool TargetReceiver::Apply(const std::string& message) {
+    try {
+        json j = json::parse(message);
+
+        auto apply = [this](const json& t) {
+            if (!t.is_object() || !t.contains("targetId")) return;
+            if (IsLost(t)) {
+                m_table->Remove(t["targetId"].get<int>());
+            } else {
+                m_table->Upsert(ParseTarget(t));
+            }
+        };
+
+        if (j.is_object() && j.contains("targets") && j["targets"].is_array()) {
+            std::vector<ArpaTarget> targets;
+            for (const auto& t : j["targets"]) {
+                if (t.is_object() && t.contains("targetId") && !IsLost(t)) {
+                    targets.push_back(ParseTarget(t));
+                }
+            }
+            m_table->Assign(targets);
+        } else if (j.is_array()) {
+            for (const auto& t : j) apply(t);
+        } else {
+            apply(j);
+        }
+    } catch (...) {
+        // Keep whatever parsed before the error
+        m_table->Publish();
+        return false;
+    }
+
+    m_table->Publish();
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Versioned table of ARPA targets with immutable snapshots
+ */
+
+#include "TargetTable.h"
+#include <algorithm>
+
+using namespace mayara;
+
+TargetTable::TargetTable()
+    : m_changed(false)
+    , m_published(std::make_shared<const std::vector<ArpaTarget>>())
+    , m_version(0)
+{
+}
+
+std::vector<ArpaTarget>::iterator TargetTable::Find(int target_id) {
+    return std::lower_bound(m_targets.begin(), m_targets.end(), target_id,
+                            [](const ArpaTarget& target, int id) { return target.targetId < id; });
+}
+
+void TargetTable::Upsert(const ArpaTarget& target) {
+    std::lock_guard<std::mutex> lock(m_write_lock);
+    auto it = Find(target.targetId);
+    if (it != m_targets.end() && it->targetId == target.targetId) {
+        *it = target;
+    } else {
+        m_targets.insert(it, target);
+    }
+    m_changed = true;
+}
+
+void TargetTable::Remove(int target_id) {
+    std::lock_guard<std::mutex> lock(m_write_lock);
+    auto it = Find(target_id);
+    if (it != m_targets.end() && it->targetId == target_id) {
+        m_targets.erase(it);
+        m_changed = true;
+    }
+}
+
+void TargetTable::Assign(const std::vector<ArpaTarget>& targets) {
+    std::lock_guard<std::mutex> lock(m_write_lock);
+    m_targets = targets;
+    std::sort(m_targets.begin(), m_targets.end(),
+              [](const ArpaTarget& a, const ArpaTarget& b) { return a.targetId < b.targetId; });
+    m_changed = true;
+}
+
+void TargetTable::Clear() {
+    std::lock_guard<std::mutex> lock(m_write_lock);
+    if (m_targets.empty()) return;
+    m_targets.clear();
+    m_changed = true;
+}
+
+void TargetTable::Publish() {
+    std::lock_guard<std::mutex> lock(m_write_lock);
+    if (!m_changed) return;
+    m_changed = false;
+
+    std::atomic_store(&m_published,
+                      std::shared_ptr<const std::vector<ArpaTarget>>(
+                          std::make_shared<std::vector<ArpaTarget>>(m_targets)));
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,347 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Local target tracking on detected blobs
+ */
+
+#include "TargetTracker.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mayara;
+
+// Tracks are dropped after a gap in the sweeps longer than this
+static const double MAX_GAP_SECONDS = 30.0;
+
+// Gates: a fixed part for measurement noise, plus the distance a target
+// can move in one sweep; new tracks have no velocity yet
+static const double MIN_GATE_METERS = 50.0;
+static const double MAX_TARGET_SPEED = 25.0;       // m/s, about 50 knots
+static const double MAX_MANEUVER_SPEED = 5.0;      // m/s of unpredicted motion
+
+// The alpha-beta gains follow a growing memory filter up to this many
+// measurements, then stay fixed (alpha 0.35, beta 0.055)
+static const uint32_t FILTER_MEMORY = 10;
+
+// Acquisitions wait this many sweeps for a blob before they are dropped
+static const uint32_t ACQUIRE_SWEEPS = 3;
+
+static const uint32_t NO_TRACK = UINT32_MAX;
+
+TargetTracker::TargetTracker()
+    : m_auto_acquire(false)
+    , m_tracking_all(false)
+    , m_anchored(false)
+    , m_ship_x(0.0)
+    , m_ship_y(0.0)
+    , m_ship_vx(0.0)
+    , m_ship_vy(0.0)
+    , m_heading(0.0)
+    , m_time(0)
+    , m_next_id(1)
+    , m_cell(0.0)
+    , m_gate_base(MIN_GATE_METERS)
+    , m_targets(std::make_shared<const std::vector<ArpaTarget>>())
+{
+}
+
+void TargetTracker::SetOwnShip(const GeoPosition& position, double heading, double cog, double sog) {
+    std::lock_guard<std::mutex> lock(m_input_lock);
+    m_own_ship.Set(position, heading, cog, sog, wxGetLocalTimeMillis().GetValue());
+}
+
+void TargetTracker::Acquire(double bearing, double distance) {
+    std::lock_guard<std::mutex> lock(m_input_lock);
+    m_acquire_queue.push_back({ bearing, distance, 0 });
+}
+
+void TargetTracker::Cancel(int target_id) {
+    std::lock_guard<std::mutex> lock(m_input_lock);
+    m_cancel_queue.push_back(target_id);
+}
+
+void TargetTracker::SetAutoAcquire(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_input_lock);
+    m_auto_acquire = enabled;
+}
+
+void TargetTracker::TakeInput() {
+    std::vector<int> cancels;
+    {
+        std::lock_guard<std::mutex> lock(m_input_lock);
+        m_ship = m_own_ship;
+        m_tracking_all = m_auto_acquire;
+        m_acquisitions.insert(m_acquisitions.end(), m_acquire_queue.begin(), m_acquire_queue.end());
+        m_acquire_queue.clear();
+        cancels.swap(m_cancel_queue);
+    }
+
+    // Cancelled tracks go with the lost ones in DropTracks()
+    for (int id : cancels) {
+        for (size_t t = 0; t < m_id.size(); t++) {
+            if (m_id[t] == id) m_misses[t] = MAX_MISSES + 1;
+        }
+    }
+}
+
+void TargetTracker::UpdateOwnShip() {
+    m_heading = m_ship.GetHeading();
+    m_ship.GetVelocity(m_ship_vx, m_ship_vy);
+    if (!m_ship.HasFix()) return;
+
+    double east = 0.0, north = 0.0;
+    if (m_anchored) OwnShip::Offset(m_anchor, m_ship.GetFix(), east, north);
+    if (!m_anchored || fabs(east) > OwnShip::REANCHOR_METERS ||
+        fabs(north) > OwnShip::REANCHOR_METERS) {
+        for (size_t t = 0; t < m_id.size(); t++) {
+            m_x[t] -= east;
+            m_y[t] -= north;
+        }
+        m_anchor = m_ship.GetFix();
+        m_anchored = true;
+    }
+    m_ship.GetPosition(m_anchor, wxGetLocalTimeMillis().GetValue(), m_ship_x, m_ship_y);
+}
+
+void TargetTracker::Update(const BlobList& blobs) {
+    TakeInput();
+    UpdateOwnShip();
+
+    double dt = (m_time != 0 && blobs.time > m_time) ? (blobs.time - m_time) / 1000.0 : 0.0;
+    if (dt > MAX_GAP_SECONDS) {
+        for (uint32_t& misses : m_misses) misses = MAX_MISSES + 1;
+        DropTracks();
+        dt = 0.0;
+    }
+    if (blobs.time != 0) m_time = blobs.time;
+
+    // Gates scale with the range, since blobs get coarser with it
+    m_gate_base = std::max(MIN_GATE_METERS, 0.02 * blobs.gridRange);
+
+    PlaceBlobs(blobs);
+    Associate(dt);
+    StartTracks(blobs);
+    DropTracks();
+    Publish();
+}
+
+void TargetTracker::PlaceBlobs(const BlobList& blobs) {
+    // Blob bearings are relative to the bow
+    const size_t count = blobs.size();
+    m_blob_x.resize(count);
+    m_blob_y.resize(count);
+    for (size_t b = 0; b < count; b++) {
+        double bearing = DegToRad(blobs.GetBearing(b) + m_heading);
+        double distance = blobs.GetDistance(b);
+        m_blob_x[b] = m_ship_x + distance * sin(bearing);
+        m_blob_y[b] = m_ship_y + distance * cos(bearing);
+    }
+    m_blob_used.assign(count, 0);
+    m_blob_track.assign(count, NO_TRACK);
+}
+
+void TargetTracker::BuildGrid(double cell) {
+    m_cell = cell;
+    const size_t count = m_blob_x.size();
+    m_grid.resize(count);
+    for (size_t b = 0; b < count; b++) {
+        int64_t cx = (int64_t)floor(m_blob_x[b] / cell);
+        int64_t cy = (int64_t)floor(m_blob_y[b] / cell);
+        m_grid[b] = { ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy, (uint32_t)b };
+    }
+    std::sort(m_grid.begin(), m_grid.end());
+}
+
+template <typename F>
+void TargetTracker::ForEachNearBlob(double x, double y, F f) const {
+    // A point within one cell of (x, y) is in one of the 3 x 3 cells
+    // around it
+    int64_t cx = (int64_t)floor(x / m_cell);
+    int64_t cy = (int64_t)floor(y / m_cell);
+    for (int64_t gx = cx - 1; gx <= cx + 1; gx++) {
+        for (int64_t gy = cy - 1; gy <= cy + 1; gy++) {
+            uint64_t key = ((uint64_t)(uint32_t)gx << 32) | (uint32_t)gy;
+            auto it = std::lower_bound(m_grid.begin(), m_grid.end(),
+                                       std::make_pair(key, (uint32_t)0));
+            for (; it != m_grid.end() && it->first == key; ++it) {
+                f(it->second);
+            }
+        }
+    }
+}
+
+void TargetTracker::Associate(double dt) {
+    const size_t tracks = m_id.size();
+
+    // Predict, and size the grid for the widest gate so every blob in a
+    // gate is in the 3 x 3 cells around the prediction. Acquisitions
+    // search twice the base gate.
+    m_gates.resize(tracks);
+    double cell = 2.0 * m_gate_base;
+    for (size_t t = 0; t < tracks; t++) {
+        m_x[t] += m_vx[t] * dt;
+        m_y[t] += m_vy[t] * dt;
+        double speed = m_hits[t] < 2 ? MAX_TARGET_SPEED : MAX_MANEUVER_SPEED;
+        m_gates[t] = m_gate_base * (1 + m_misses[t]) + speed * std::min(dt, 10.0);
+        cell = std::max(cell, m_gates[t]);
+    }
+    BuildGrid(cell);
+
+    m_candidates.clear();
+    for (size_t t = 0; t < tracks; t++) {
+        double gate2 = m_gates[t] * m_gates[t];
+        ForEachNearBlob(m_x[t], m_y[t], [&](uint32_t b) {
+            double dx = m_blob_x[b] - m_x[t];
+            double dy = m_blob_y[b] - m_y[t];
+            double d2 = dx * dx + dy * dy;
+            if (d2 <= gate2) m_candidates.push_back({ (float)d2, (uint32_t)t, b });
+        });
+    }
+
+    // Nearest pairs first, each track and blob used once
+    std::sort(m_candidates.begin(), m_candidates.end());
+    m_track_hit.assign(tracks, 0);
+    for (const Candidate& c : m_candidates) {
+        if (m_track_hit[c.track] || m_blob_used[c.blob]) continue;
+        m_track_hit[c.track] = 1;
+        m_blob_used[c.blob] = 1;
+        m_blob_track[c.blob] = c.track;
+
+        uint32_t t = c.track;
+        uint32_t n = std::min(m_hits[t] + 1, FILTER_MEMORY);
+        double alpha = 2.0 * (2.0 * n - 1.0) / (n * (n + 1.0));
+        double beta = 6.0 / (n * (n + 1.0));
+        double rx = m_blob_x[c.blob] - m_x[t];
+        double ry = m_blob_y[c.blob] - m_y[t];
+        m_x[t] += alpha * rx;
+        m_y[t] += alpha * ry;
+        if (dt > 0.0) {
+            m_vx[t] += beta * rx / dt;
+            m_vy[t] += beta * ry / dt;
+        }
+        m_hits[t]++;
+        m_misses[t] = 0;
+    }
+
+    // The others coast on their prediction
+    for (size_t t = 0; t < tracks; t++) {
+        if (!m_track_hit[t]) m_misses[t]++;
+    }
+}
+
+void TargetTracker::StartTracks(const BlobList& blobs) {
+    double radius2 = 4.0 * m_gate_base * m_gate_base;
+    size_t kept = 0;
+    for (size_t a = 0; a < m_acquisitions.size(); a++) {
+        // Relative to the bow, like the blob bearings
+        Acquisition& acquisition = m_acquisitions[a];
+        double bearing = DegToRad(acquisition.bearing + m_heading);
+        double x = m_ship_x + acquisition.distance * sin(bearing);
+        double y = m_ship_y + acquisition.distance * cos(bearing);
+
+        // Nearest blob, which may already be followed by a track
+        uint32_t nearest = NO_TRACK;
+        double nearest2 = radius2;
+        ForEachNearBlob(x, y, [&](uint32_t b) {
+            double dx = m_blob_x[b] - x;
+            double dy = m_blob_y[b] - y;
+            double d2 = dx * dx + dy * dy;
+            if (d2 <= nearest2) {
+                nearest = b;
+                nearest2 = d2;
+            }
+        });
+
+        if (nearest == NO_TRACK) {
+            if (++acquisition.sweeps < ACQUIRE_SWEEPS) m_acquisitions[kept++] = acquisition;
+            continue;
+        }
+        if (!m_blob_used[nearest]) {
+            m_blob_used[nearest] = 1;
+            AddTrack(nearest, true);
+            continue;
+        }
+
+        // Already tracked: make sure it is reported
+        if (m_blob_track[nearest] != NO_TRACK) m_manual[m_blob_track[nearest]] = 1;
+    }
+    m_acquisitions.resize(kept);
+
+    if (m_tracking_all) {
+        for (uint32_t b = 0; b < blobs.size(); b++) {
+            if (!m_blob_used[b]) AddTrack(b, false);
+        }
+    }
+}
+
+void TargetTracker::AddTrack(uint32_t blob, bool manual) {
+    m_id.push_back(m_next_id++);
+    m_x.push_back(m_blob_x[blob]);
+    m_y.push_back(m_blob_y[blob]);
+    m_vx.push_back(0.0);
+    m_vy.push_back(0.0);
+    m_hits.push_back(1);
+    m_misses.push_back(0);
+    m_manual.push_back(manual ? 1 : 0);
+    m_track_hit.push_back(1);
+}
+
+void TargetTracker::DropTracks() {
+    size_t kept = 0;
+    for (size_t t = 0; t < m_id.size(); t++) {
+        if (m_misses[t] > MAX_MISSES) continue;
+        m_id[kept] = m_id[t];
+        m_x[kept] = m_x[t];
+        m_y[kept] = m_y[t];
+        m_vx[kept] = m_vx[t];
+        m_vy[kept] = m_vy[t];
+        m_hits[kept] = m_hits[t];
+        m_misses[kept] = m_misses[t];
+        m_manual[kept] = m_manual[t];
+        kept++;
+    }
+    m_id.resize(kept);
+    m_x.resize(kept);
+    m_y.resize(kept);
+    m_vx.resize(kept);
+    m_vy.resize(kept);
+    m_hits.resize(kept);
+    m_misses.resize(kept);
+    m_manual.resize(kept);
+}
+
+void TargetTracker::Publish() {
+    auto targets = std::make_shared<std::vector<ArpaTarget>>();
+    targets->reserve(m_id.size());
+    for (size_t t = 0; t < m_id.size(); t++) {
+        if (!m_manual[t] && m_hits[t] < CONFIRM_HITS) continue;
+
+        // Position and velocity relative to own ship
+        double px = m_x[t] - m_ship_x;
+        double py = m_y[t] - m_ship_y;
+        double rvx = m_vx[t] - m_ship_vx;
+        double rvy = m_vy[t] - m_ship_vy;
+
+        // Closest approach along the relative motion, now if it is past
+        double tcpa = 0.0;
+        double speed2 = rvx * rvx + rvy * rvy;
+        if (speed2 > 1e-6) {
+            tcpa = std::max(0.0, -(px * rvx + py * rvy) / speed2);
+        }
+        double cx = px + rvx * tcpa;
+        double cy = py + rvy * tcpa;
+
+        ArpaTarget target;
+        target.targetId = m_id[t];
+        target.bearing = fmod(RadToDeg(atan2(px, py)) + 360.0, 360.0);
+        target.distance = sqrt(px * px + py * py);
+        target.speed = sqrt(m_vx[t] * m_vx[t] + m_vy[t] * m_vy[t]) / OwnShip::KNOTS_TO_MPS;
+        target.course = fmod(RadToDeg(atan2(m_vx[t], m_vy[t])) + 360.0, 360.0);
+        target.cpa = sqrt(cx * cx + cy * cy);
+        target.tcpa = tcpa / 60.0;
+        targets->push_back(target);
+    }
+    std::atomic_store(&m_targets, std::shared_ptr<const std::vector<ArpaTarget>>(targets));
+}
@@ -0,0 +1,318 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Target trail history as a per-cell age grid
+ */
+
+#include "TrailBuffer.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mayara;
+
+// The expiry scan visits every row once per EXPIRE_PERIOD ticks and clears
+// stamps at least EXPIRE_AGE old. A stamp is therefore gone before it is
+// EXPIRE_AGE + EXPIRE_PERIOD old, well short of wrapping at 65536, and
+// never while it is younger than MAX_LENGTH_TICKS and still visible.
+static const uint64_t EXPIRE_PERIOD = 8192;
+static const uint32_t EXPIRE_AGE = 0x8000;
+
+TrailBuffer::TrailBuffer(size_t size)
+    : m_mode(TrailMode::Off)
+    , m_threshold(128)
+    , m_generation(1)
+    , m_spokes(0)
+    , m_spoke_len(0)
+    , m_grid_range(0)
+    , m_cell_meters(0.0)
+    , m_anchored(false)
+    , m_ship_x(0.5)
+    , m_ship_y(0.5)
+    , m_window_x(0)
+    , m_window_y(0)
+    , m_heading(0.0)
+    , m_tick(0)
+    , m_now(1)
+    , m_expired_tick(0)
+    , m_expire_row(0)
+    , m_sequence(0)
+    , m_last_cell_count(0)
+{
+    // Power of two so world cells wrap with a mask, at least one SIMD
+    // block per row
+    m_size = 64;
+    while (m_size < size) m_size <<= 1;
+    m_mask = m_size - 1;
+
+    m_stamps.assign(m_size * m_size, 0);
+    m_row_generation.assign(m_size, m_generation);
+}
+
+TrailBuffer::~TrailBuffer() {
+}
+
+void TrailBuffer::SetMode(TrailMode mode) {
+    if (mode == m_mode) return;
+    m_mode = mode;
+    m_anchored = false;
+    Clear();
+}
+
+void TrailBuffer::SetOwnShip(const GeoPosition& position, double heading, double cog, double sog) {
+    m_own_ship.Set(position, heading, cog, sog, wxGetLocalTimeMillis().GetValue());
+}
+
+void TrailBuffer::Clear() {
+    std::fill(m_stamps.begin(), m_stamps.end(), 0);
+    m_generation++;
+    std::fill(m_row_generation.begin(), m_row_generation.end(), m_generation);
+    m_expired_tick = m_tick;
+}
+
+void TrailBuffer::Update(SpokeBuffer* buffer) {
+    m_last_cell_count = 0;
+    if (!buffer || m_mode == TrailMode::Off) return;
+
+    size_t spokes = buffer->GetSpokes();
+    size_t spoke_len = buffer->GetMaxSpokeLen();
+    uint32_t grid_range = buffer->GetGridRange();
+    if (spokes == 0 || spoke_len == 0 || grid_range == 0) return;
+
+    int64_t now_ms = wxGetLocalTimeMillis().GetValue();
+    m_tick = (uint64_t)now_ms / TICK_MS;
+    m_now = (uint16_t)m_tick;
+    if (m_now == 0) m_now = 1;
+    m_generation++;
+
+    if (spokes != m_spokes || spoke_len != m_spoke_len) {
+        m_spokes = spokes;
+        m_spoke_len = spoke_len;
+        m_sin.resize(spokes);
+        m_cos.resize(spokes);
+        for (size_t k = 0; k < spokes; k++) {
+            double angle = 2.0 * M_PI * k / spokes;
+            m_sin[k] = (float)sin(angle);
+            m_cos[k] = (float)cos(angle);
+        }
+        m_unpacked.resize(spoke_len);
+        m_grid_range = 0;
+    }
+
+    // Cells are sized so the grid spans the radar disk; at a new range
+    // the old trails would be drawn at the wrong scale
+    if (grid_range != m_grid_range) {
+        m_grid_range = grid_range;
+        m_cell_meters = 2.0 * grid_range / m_size;
+        m_anchored = false;
+        Clear();
+    }
+
+    // Own ship in world cells. In relative mode, and in true motion until
+    // the first fix, it stays in the middle of cell (0, 0) and the world
+    // moves past it.
+    if (m_mode == TrailMode::TrueMotion && m_own_ship.HasFix()) {
+        if (!m_anchored) {
+            // Trails placed relative to the ship have no world position
+            m_anchor = m_own_ship.GetFix();
+            m_anchored = true;
+            Clear();
+        }
+        double east, north;
+        m_own_ship.GetPosition(m_anchor, now_ms, east, north);
+        if (fabs(east) > OwnShip::REANCHOR_METERS || fabs(north) > OwnShip::REANCHOR_METERS) {
+            Reanchor(east, north);
+            m_own_ship.GetPosition(m_anchor, now_ms, east, north);
+        }
+        m_ship_x = east / m_cell_meters;
+        m_ship_y = -north / m_cell_meters;
+    } else {
+        m_ship_x = 0.5;
+        m_ship_y = 0.5;
+    }
+    Scroll((int64_t)floor(m_ship_x), (int64_t)floor(m_ship_y));
+
+    // Spokes are relative to the bow
+    m_heading = m_own_ship.GetHeading();
+    float sin_h = (float)sin(DegToRad(m_heading));
+    float cos_h = (float)cos(DegToRad(m_heading));
+    float cells_per_sample = (float)m_size / (2.0f * spoke_len);
+
+    const uint8_t* data = buffer->GetTextureData();
+    size_t row_bytes = buffer->GetRowBytes();
+    buffer->GetDirtySector(m_sequence, m_dirty_runs);
+    for (const DirtyRun& run : m_dirty_runs) {
+        for (uint32_t k = run.first; k < run.first + run.count; k++) {
+            const uint8_t* row = data + (size_t)k * row_bytes;
+            if (buffer->IsPacked()) {
+                UnpackNibbles(row, spoke_len, m_unpacked.data());
+                row = m_unpacked.data();
+            }
+
+            // Bearing is clockwise from north, grid y runs south
+            float s = m_sin[k] * cos_h + m_cos[k] * sin_h;
+            float c = m_cos[k] * cos_h - m_sin[k] * sin_h;
+            StampSpoke(row, s * cells_per_sample, -c * cells_per_sample);
+        }
+    }
+    m_sequence = buffer->GetSequence();
+
+    Expire();
+}
+
+void TrailBuffer::StampSpoke(const uint8_t* samples, float step_x, float step_y) {
+    const size_t len = m_spoke_len;
+    const int64_t half = (int64_t)m_size / 2;
+    size_t i = 0;
+
+    // Stamp sample i at the center of its range bin, if it is inside the
+    // window; the ship is up to a cell off center
+    auto stamp = [&](size_t index) {
+        float r = index + 0.5f;
+        int64_t x = (int64_t)floor(m_ship_x + r * step_x);
+        int64_t y = (int64_t)floor(m_ship_y + r * step_y);
+        if (x - m_window_x < -half || x - m_window_x >= half ||
+            y - m_window_y < -half || y - m_window_y >= half) {
+            return;
+        }
+        size_t row = (size_t)y & m_mask;
+        m_stamps[row * m_size + ((size_t)x & m_mask)] = m_now;
+        TouchRow(row);
+        m_last_cell_count++;
+    };
+
+    // Most of a spoke is below the threshold: test 16 samples at a time
+    // and only visit the blocks with an echo
+#if defined(MAYARA_SSE2)
+    const __m128i threshold = _mm_set1_epi8((char)m_threshold);
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(samples + i));
+        // v >= threshold exactly when max(v, threshold) == v
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, threshold), v));
+        if (mask == 0) continue;
+        for (int b = 0; b < 16; b++) {
+            if (mask & (1 << b)) stamp(i + b);
+        }
+    }
+#elif defined(MAYARA_NEON)
+    const uint8x16_t threshold = vdupq_n_u8(m_threshold);
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t hit = vcgeq_u8(vld1q_u8(samples + i), threshold);
+        uint8x8_t any = vorr_u8(vget_low_u8(hit), vget_high_u8(hit));
+        if (vget_lane_u64(vreinterpret_u64_u8(any), 0) == 0) continue;
+        for (size_t b = 0; b < 16; b++) {
+            if (samples[i + b] >= m_threshold) stamp(i + b);
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (samples[i] >= m_threshold) stamp(i);
+    }
+}
+
+void TrailBuffer::Reanchor(double east, double north) {
+    // Whole grid spans keep every world cell on its texel, so the stamps
+    // stay put and only the window coordinates change
+    double span = m_size * m_cell_meters;
+    int64_t spans_x = (int64_t)llround(east / span);
+    int64_t spans_y = (int64_t)llround(-north / span);
+    if (spans_x == 0 && spans_y == 0) return;
+
+    int64_t size = (int64_t)m_size;
+    m_anchor = OwnShip::Move(m_anchor, spans_x * span, -spans_y * span);
+    m_window_x -= spans_x * size;
+    m_window_y -= spans_y * size;
+}
+
+void TrailBuffer::Scroll(int64_t cell_x, int64_t cell_y) {
+    int64_t dx = cell_x - m_window_x;
+    int64_t dy = cell_y - m_window_y;
+    if (dx == 0 && dy == 0) return;
+
+    int64_t size = (int64_t)m_size;
+    int64_t half = size / 2;
+    if (dx <= -size || dx >= size || dy <= -size || dy >= size) {
+        Clear();
+    } else {
+        // The texels of the columns and rows leaving the window are reused
+        // for those entering it
+        for (int64_t x = m_window_x - half; x < m_window_x - half + dx; x++) ClearColumn(x);
+        for (int64_t x = m_window_x + half + dx; x < m_window_x + half; x++) ClearColumn(x);
+        for (int64_t y = m_window_y - half; y < m_window_y - half + dy; y++) ClearRow(y);
+        for (int64_t y = m_window_y + half + dy; y < m_window_y + half; y++) ClearRow(y);
+    }
+
+    m_window_x = cell_x;
+    m_window_y = cell_y;
+}
+
+void TrailBuffer::ClearColumn(int64_t x) {
+    size_t column = (size_t)x & m_mask;
+    for (size_t row = 0; row < m_size; row++) {
+        m_stamps[row * m_size + column] = 0;
+        TouchRow(row);
+    }
+}
+
+void TrailBuffer::ClearRow(int64_t y) {
+    size_t row = (size_t)y & m_mask;
+    std::fill_n(m_stamps.begin() + row * m_size, m_size, 0);
+    TouchRow(row);
+}
+
+void TrailBuffer::Expire() {
+    // Rows due since the last scan, at a steady EXPIRE_PERIOD per grid
+    uint64_t rows = m_tick * m_size / EXPIRE_PERIOD - m_expired_tick * m_size / EXPIRE_PERIOD;
+    rows = std::min<uint64_t>(rows, m_size);
+    m_expired_tick = m_tick;
+
+    for (uint64_t n = 0; n < rows; n++) {
+        size_t row = m_expire_row;
+        m_expire_row = (m_expire_row + 1) & m_mask;
+
+        uint16_t* stamps = &m_stamps[row * m_size];
+        bool changed = false;
+        size_t x = 0;
+
+        // Age wraps at 16 bits, so it is EXPIRE_AGE or more exactly when
+        // it is negative as a signed value
+#if defined(MAYARA_SSE2)
+        const __m128i now = _mm_set1_epi16((short)m_now);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 8 <= m_size; x += 8) {
+            __m128i s = _mm_loadu_si128((const __m128i*)(stamps + x));
+            __m128i age = _mm_sub_epi16(now, s);
+            __m128i stale = _mm_andnot_si128(_mm_cmpeq_epi16(s, zero),
+                                             _mm_cmplt_epi16(age, zero));
+            if (_mm_movemask_epi8(stale) == 0) continue;
+            _mm_storeu_si128((__m128i*)(stamps + x), _mm_andnot_si128(stale, s));
+            changed = true;
+        }
+#elif defined(MAYARA_NEON)
+        const uint16x8_t now = vdupq_n_u16(m_now);
+        const uint16x8_t zero = vdupq_n_u16(0);
+        for (; x + 8 <= m_size; x += 8) {
+            uint16x8_t s = vld1q_u16(stamps + x);
+            int16x8_t age = vreinterpretq_s16_u16(vsubq_u16(now, s));
+            uint16x8_t stale = vbicq_u16(vcltq_s16(age, vreinterpretq_s16_u16(zero)),
+                                         vceqq_u16(s, zero));
+            uint16x4_t any = vorr_u16(vget_low_u16(stale), vget_high_u16(stale));
+            if (vget_lane_u64(vreinterpret_u64_u16(any), 0) == 0) continue;
+            vst1q_u16(stamps + x, vbicq_u16(s, stale));
+            changed = true;
+        }
+#endif
+
+        for (; x < m_size; x++) {
+            if (stamps[x] != 0 && (uint16_t)(m_now - stamps[x]) >= EXPIRE_AGE) {
+                stamps[x] = 0;
+                changed = true;
+            }
+        }
+
+        if (changed) TouchRow(row);
+    }
+}
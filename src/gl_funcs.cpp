@@ -32,6 +32,18 @@ PFNGLUNIFORM2FPROC          glUniform2f_ptr = nullptr;
 PFNGLUNIFORM3FPROC          glUniform3f_ptr = nullptr;
 PFNGLUNIFORM4FPROC          glUniform4f_ptr = nullptr;
 PFNGLUNIFORMMATRIX4FVPROC   glUniformMatrix4fv_ptr = nullptr;
+PFNGLGETATTRIBLOCATIONPROC  glGetAttribLocation_ptr = nullptr;
+PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer_ptr = nullptr;
+PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray_ptr = nullptr;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray_ptr = nullptr;
+PFNGLACTIVETEXTUREPROC      glActiveTexture_ptr = nullptr;
+
+PFNGLGENBUFFERSPROC         glGenBuffers_ptr = nullptr;
+PFNGLDELETEBUFFERSPROC      glDeleteBuffers_ptr = nullptr;
+PFNGLBINDBUFFERPROC         glBindBuffer_ptr = nullptr;
+PFNGLBUFFERDATAPROC         glBufferData_ptr = nullptr;
+PFNGLMAPBUFFERPROC          glMapBuffer_ptr = nullptr;
+PFNGLUNMAPBUFFERPROC        glUnmapBuffer_ptr = nullptr;
 
 static bool s_gl_funcs_initialized = false;
 
@@ -59,13 +71,37 @@ bool InitGLFunctions() {
     glUniform3f_ptr = (PFNGLUNIFORM3FPROC)wglGetProcAddress("glUniform3f");
     glUniform4f_ptr = (PFNGLUNIFORM4FPROC)wglGetProcAddress("glUniform4f");
     glUniformMatrix4fv_ptr = (PFNGLUNIFORMMATRIX4FVPROC)wglGetProcAddress("glUniformMatrix4fv");
+    glGetAttribLocation_ptr = (PFNGLGETATTRIBLOCATIONPROC)wglGetProcAddress("glGetAttribLocation");
+    glVertexAttribPointer_ptr = (PFNGLVERTEXATTRIBPOINTERPROC)wglGetProcAddress("glVertexAttribPointer");
+    glEnableVertexAttribArray_ptr = (PFNGLENABLEVERTEXATTRIBARRAYPROC)wglGetProcAddress("glEnableVertexAttribArray");
+    glDisableVertexAttribArray_ptr = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)wglGetProcAddress("glDisableVertexAttribArray");
+    glActiveTexture_ptr = (PFNGLACTIVETEXTUREPROC)wglGetProcAddress("glActiveTexture");
+
+    // Optional - only needed for PBO uploads, see HaveGLBufferFunctions()
+    glGenBuffers_ptr = (PFNGLGENBUFFERSPROC)wglGetProcAddress("glGenBuffers");
+    glDeleteBuffers_ptr = (PFNGLDELETEBUFFERSPROC)wglGetProcAddress("glDeleteBuffers");
+    glBindBuffer_ptr = (PFNGLBINDBUFFERPROC)wglGetProcAddress("glBindBuffer");
+    glBufferData_ptr = (PFNGLBUFFERDATAPROC)wglGetProcAddress("glBufferData");
+    glMapBuffer_ptr = (PFNGLMAPBUFFERPROC)wglGetProcAddress("glMapBuffer");
+    glUnmapBuffer_ptr = (PFNGLUNMAPBUFFERPROC)wglGetProcAddress("glUnmapBuffer");
 
     // Check if critical functions were loaded
     s_gl_funcs_initialized = (glCreateShader_ptr != nullptr &&
                               glCreateProgram_ptr != nullptr &&
-                              glLinkProgram_ptr != nullptr);
+                              glLinkProgram_ptr != nullptr &&
+                              glVertexAttribPointer_ptr != nullptr &&
+                              glActiveTexture_ptr != nullptr);
 
     return s_gl_funcs_initialized;
 }
 
+bool HaveGLBufferFunctions() {
+    return glGenBuffers_ptr != nullptr &&
+           glDeleteBuffers_ptr != nullptr &&
+           glBindBuffer_ptr != nullptr &&
+           glBufferData_ptr != nullptr &&
+           glMapBuffer_ptr != nullptr &&
+           glUnmapBuffer_ptr != nullptr;
+}
+
 #endif  // __WXMSW__
@@ -22,6 +22,7 @@
 #include "icons.h"
 
 #include <ixwebsocket/IXNetSystem.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -73,6 +74,11 @@ public:
                                      PlugIn_ViewPort* vp,
                                      int canvasIndex) override;
 
+    // -------- Non-GL overlay rendering --------
+    bool RenderOverlayMultiCanvas(wxDC& dc,
+                                  PlugIn_ViewPort* vp,
+                                  int canvasIndex) override;
+
     // Position updates
     void SetPositionFixEx(PlugIn_Position_Fix_Ex& pfix) override;
 
@@ -90,6 +96,19 @@ public:
     int GetReconnectInterval() const { return m_reconnect_interval; }
     bool GetShowOverlay() const { return m_show_overlay; }
     bool GetShowPPIWindow() const { return m_show_ppi_window; }
+    bool GetPBOUpload() const { return m_pbo_upload; }
+    bool GetPolarLookup() const { return m_polar_lookup; }
+    int GetSpokeDecimation() const { return m_spoke_decimation; }
+    int GetDecimationMode() const { return m_decimation_mode; }
+    double GetAfterglow() const { return m_afterglow; }
+    int GetTrailMode() const { return m_trail_mode; }
+    int GetTrailLength() const { return m_trail_length; }
+    int GetIntegrationMode() const { return m_integration_mode; }
+    int GetIntegrationRevolutions() const { return m_integration_revolutions; }
+    int GetIntegrationRequired() const { return m_integration_required; }
+    bool GetLocalDetection() const { return m_local_detection; }
+    double GetDetectionThreshold() const { return m_detection_threshold; }
+    bool GetAutoAcquire() const { return m_auto_acquire; }
 
     void SetServerHost(const std::string& host) { m_server_host = host; }
     void SetServerPort(int port) { m_server_port = port; }
@@ -97,9 +116,24 @@ public:
     void SetReconnectInterval(int interval) { m_reconnect_interval = interval; }
     void SetShowOverlay(bool show) { m_show_overlay = show; }
     void SetShowPPIWindow(bool show) { m_show_ppi_window = show; }
+    void SetPBOUpload(bool use) { m_pbo_upload = use; }
+    void SetPolarLookup(bool use) { m_polar_lookup = use; }
+    void SetSpokeDecimation(int factor) { m_spoke_decimation = factor; }
+    void SetDecimationMode(int mode) { m_decimation_mode = mode; }
+    void SetAfterglow(double time_constant) { m_afterglow = time_constant; }
+    void SetTrailMode(int mode) { m_trail_mode = mode; }
+    void SetTrailLength(int seconds) { m_trail_length = seconds; }
+    void SetIntegrationMode(int mode) { m_integration_mode = mode; }
+    void SetIntegrationRevolutions(int revolutions) { m_integration_revolutions = revolutions; }
+    void SetIntegrationRequired(int required) { m_integration_required = required; }
+    void SetLocalDetection(bool detect) { m_local_detection = detect; }
+    void SetDetectionThreshold(double factor) { m_detection_threshold = factor; }
+    void SetAutoAcquire(bool enabled) { m_auto_acquire = enabled; }
 
     GeoPosition GetOwnPosition() const { return m_own_position; }
     double GetHeading() const { return m_heading; }
+    double GetCog() const { return m_cog; }
+    double GetSog() const { return m_sog; }
     bool IsPositionValid() const { return m_position_valid; }
 
     mayara::RadarManager* GetRadarManager() { return m_radar_manager.get(); }
@@ -122,6 +156,19 @@ private:
     int m_reconnect_interval;
     bool m_show_overlay;
     bool m_show_ppi_window;
+    bool m_pbo_upload;
+    bool m_polar_lookup;
+    int m_spoke_decimation;     // Spokes merged into one, 1 = off
+    int m_decimation_mode;      // mayara::DecimationMode
+    double m_afterglow;         // Echo fade time constant in seconds, 0 = off
+    int m_trail_mode;           // mayara::TrailMode
+    int m_trail_length;         // Seconds
+    int m_integration_mode;     // 0 = off, else mayara::IntegrationMode + 1
+    int m_integration_revolutions;
+    int m_integration_required; // M of M-of-N
+    bool m_local_detection;
+    double m_detection_threshold;   // CFAR factor over the local mean
+    bool m_auto_acquire;            // Track every detected blob
 
     // Radar management
     std::unique_ptr<mayara::RadarManager> m_radar_manager;
@@ -163,6 +210,19 @@ mayara_server_pi::mayara_server_pi(void* ppimgr)
     , m_reconnect_interval(DEFAULT_RECONNECT_INTERVAL)
     , m_show_overlay(true)
     , m_show_ppi_window(false)
+    , m_pbo_upload(true)
+    , m_polar_lookup(false)
+    , m_spoke_decimation(1)
+    , m_decimation_mode(0)
+    , m_afterglow(0.0)
+    , m_trail_mode(0)
+    , m_trail_length(60)
+    , m_integration_mode(0)
+    , m_integration_revolutions(3)
+    , m_integration_required(2)
+    , m_local_detection(false)
+    , m_detection_threshold(3.0)
+    , m_auto_acquire(false)
     , m_heading(0.0)
     , m_cog(0.0)
     , m_sog(0.0)
@@ -207,7 +267,8 @@ int mayara_server_pi::Init() {
     // Don't start radar manager or timer here - wait for user to click toolbar
     // User must click the toolbar icon to start radar connection
 
-    return WANTS_PREFERENCES | WANTS_OPENGL_OVERLAY_CALLBACK | WANTS_NMEA_EVENTS | INSTALLS_TOOLBAR_TOOL;
+    return WANTS_PREFERENCES | WANTS_OVERLAY_CALLBACK | WANTS_OPENGL_OVERLAY_CALLBACK |
+           WANTS_NMEA_EVENTS | INSTALLS_TOOLBAR_TOOL;
 }
 
 bool mayara_server_pi::DeInit() {
@@ -439,7 +500,9 @@ bool mayara_server_pi::RenderGLOverlayMultiCanvas(
             // Initialize renderer on first use (when GL context is active)
             if (!renderer->IsInitialized()) {
                 if (do_log) wxLogMessage("MaYaRa: Initializing renderer");
-                renderer->Init(radar->GetSpokesPerRevolution(), radar->GetMaxSpokeLength());
+                renderer->Init(radar->GetSpokeBuffer()->GetSpokes(),
+                               radar->GetSpokeBuffer()->GetMaxSpokeLen(),
+                               radar->GetSpokeBuffer()->IsPacked());
                 if (do_log) wxLogMessage("MaYaRa: Renderer Init() returned");
             }
             if (!renderer->IsInitialized()) {
@@ -450,12 +513,22 @@ bool mayara_server_pi::RenderGLOverlayMultiCanvas(
             if (do_log) wxLogMessage("MaYaRa: Drawing overlay at range %.0fm", radar->GetRangeMeters());
 
             if (do_log) wxLogMessage("MaYaRa: Calling UpdateTexture");
+            renderer->SetUsePBO(m_pbo_upload);
+            renderer->SetUsePolarLookup(m_polar_lookup);
+            renderer->SetAfterglow(m_afterglow);
             renderer->UpdateTexture(radar->GetSpokeBuffer());
+
+            auto* trails = radar->GetTrailBuffer();
+            trails->SetMode((mayara::TrailMode)std::min(std::max(m_trail_mode, 0), 2));
+            trails->SetOwnShip(m_own_position, m_heading, m_cog, m_sog);
+            trails->Update(radar->GetSpokeBuffer());
+            renderer->SetTrailLength(m_trail_length);
+            renderer->UpdateTrails(trails);
             if (do_log) wxLogMessage("MaYaRa: Calling DrawOverlay");
             renderer->DrawOverlay(
                 pcontext,
                 vp,
-                radar->GetRangeMeters(),
+                radar->GetImageRangeMeters(),
                 m_own_position,
                 m_heading
             );
@@ -473,12 +546,46 @@ bool mayara_server_pi::RenderGLOverlayMultiCanvas(
     }
 }
 
+bool mayara_server_pi::RenderOverlayMultiCanvas(
+    wxDC& dc,
+    PlugIn_ViewPort* vp,
+    int canvasIndex)
+{
+    // Chart canvas without OpenGL: rasterize the radar image on the CPU
+    if (!m_show_overlay || !m_position_valid) return false;
+    if (!m_radar_manager || !m_radar_manager->IsConnected()) return false;
+
+    bool drawn = false;
+    for (auto* radar : m_radar_manager->GetActiveRadars()) {
+        if (!radar || radar->GetStatus() != RadarStatus::Transmit) continue;
+
+        auto* renderer = radar->GetOverlayRenderer();
+        if (!renderer) continue;
+
+        renderer->DrawOverlayDC(dc, vp, radar->GetImageRangeMeters(),
+                                m_own_position, m_heading,
+                                radar->GetSpokeBuffer());
+        drawn = true;
+    }
+
+    return drawn;
+}
+
 void mayara_server_pi::SetPositionFixEx(PlugIn_Position_Fix_Ex& pfix) {
     m_own_position = GeoPosition(pfix.Lat, pfix.Lon);
     m_heading = pfix.Hdt;
     m_cog = pfix.Cog;
     m_sog = pfix.Sog;
     m_position_valid = true;
+
+    // Local trackers run on the ingest workers and only queue the fix
+    if (m_radar_manager) {
+        for (auto* radar : m_radar_manager->GetActiveRadars()) {
+            if (auto* tracker = radar->GetTracker()) {
+                tracker->SetOwnShip(m_own_position, m_heading, m_cog, m_sog);
+            }
+        }
+    }
 }
 
 void mayara_server_pi::OnTimerNotify(wxTimerEvent& event) {
@@ -553,6 +660,19 @@ bool mayara_server_pi::LoadConfig() {
     // User must click toolbar to activate
     m_show_overlay = false;
     m_config->Read("ShowPPIWindow", &m_show_ppi_window, false);
+    m_config->Read("PBOUpload", &m_pbo_upload, true);
+    m_config->Read("PolarLookup", &m_polar_lookup, false);
+    m_config->Read("SpokeDecimation", &m_spoke_decimation, 1);
+    m_config->Read("DecimationMode", &m_decimation_mode, 0);
+    m_config->Read("Afterglow", &m_afterglow, 0.0);
+    m_config->Read("TrailMode", &m_trail_mode, 0);
+    m_config->Read("TrailLength", &m_trail_length, 60);
+    m_config->Read("IntegrationMode", &m_integration_mode, 0);
+    m_config->Read("IntegrationRevolutions", &m_integration_revolutions, 3);
+    m_config->Read("IntegrationRequired", &m_integration_required, 2);
+    m_config->Read("LocalDetection", &m_local_detection, false);
+    m_config->Read("DetectionThreshold", &m_detection_threshold, 3.0);
+    m_config->Read("AutoAcquire", &m_auto_acquire, false);
 
     return true;
 }
@@ -568,6 +688,19 @@ bool mayara_server_pi::SaveConfig() {
     m_config->Write("ReconnectInterval", m_reconnect_interval);
     m_config->Write("ShowOverlay", m_show_overlay);
     m_config->Write("ShowPPIWindow", m_show_ppi_window);
+    m_config->Write("PBOUpload", m_pbo_upload);
+    m_config->Write("PolarLookup", m_polar_lookup);
+    m_config->Write("SpokeDecimation", m_spoke_decimation);
+    m_config->Write("DecimationMode", m_decimation_mode);
+    m_config->Write("Afterglow", m_afterglow);
+    m_config->Write("TrailMode", m_trail_mode);
+    m_config->Write("TrailLength", m_trail_length);
+    m_config->Write("IntegrationMode", m_integration_mode);
+    m_config->Write("IntegrationRevolutions", m_integration_revolutions);
+    m_config->Write("IntegrationRequired", m_integration_required);
+    m_config->Write("LocalDetection", m_local_detection);
+    m_config->Write("DetectionThreshold", m_detection_threshold);
+    m_config->Write("AutoAcquire", m_auto_acquire);
 
     return true;
 }
@@ -0,0 +1,133 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Counts heap allocations in the steady state of the spoke ingest path
+ */
+
+#include "SpokeIngest.h"
+#include "SpokeDecimator.h"
+#include "SpokeBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace mayara;
+
+// Every allocation of the process, on any thread, goes through these
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static const size_t SPOKES = 2048;
+static const size_t SPOKE_LEN = 512;
+static const size_t SPOKES_PER_FRAME = 16;
+static const int WARMUP_REVOLUTIONS = 3;
+static const int REVOLUTIONS = 20;
+
+static void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// RadarMessage frames covering one revolution
+static std::vector<std::vector<uint8_t>> MakeFrames() {
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t first = 0; first < SPOKES; first += SPOKES_PER_FRAME) {
+        std::vector<uint8_t> message;
+        PutVarint(message, 1 << 3);               // radar
+        PutVarint(message, 1);
+        for (size_t angle = first; angle < first + SPOKES_PER_FRAME; angle++) {
+            std::vector<uint8_t> spoke;
+            PutVarint(spoke, 1 << 3);             // angle
+            PutVarint(spoke, angle);
+            PutVarint(spoke, 3 << 3);             // range
+            PutVarint(spoke, 1852);
+            PutVarint(spoke, 4 << 3);             // time
+            PutVarint(spoke, 1700000000000ull);
+            PutVarint(spoke, (5 << 3) | 2);       // data
+            PutVarint(spoke, SPOKE_LEN);
+            for (size_t i = 0; i < SPOKE_LEN; i++) {
+                spoke.push_back((uint8_t)rand());
+            }
+            PutVarint(message, (2 << 3) | 2);     // spokes
+            PutVarint(message, spoke.size());
+            message.insert(message.end(), spoke.begin(), spoke.end());
+        }
+        frames.push_back(message);
+    }
+    return frames;
+}
+
+int main() {
+    SpokeBuffer buffer(SPOKES / 4, SPOKE_LEN);
+    SpokeDecimator decimator(SPOKES, 4, SPOKE_LEN, DecimationMode::Max);
+    std::vector<SpokeData> decimated;
+
+    SpokeIngest ingest([&](const SpokeData* spokes, size_t count) {
+        decimator.Process(spokes, count, decimated);
+        if (!decimated.empty()) {
+            buffer.WriteSpokes(decimated.data(), decimated.size());
+        }
+    }, SPOKE_LEN);
+
+    std::vector<std::vector<uint8_t>> frames = MakeFrames();
+    uint64_t submitted = 0;
+
+    // Feed revolutions like the socket thread, draining like the render
+    // thread, then wait for the worker to finish every frame
+    auto run = [&](int revolutions) {
+        for (int r = 0; r < revolutions; r++) {
+            for (const auto& frame : frames) {
+                ingest.Submit(frame.data(), frame.size());
+                submitted++;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            buffer.Drain();
+        }
+        while (ingest.GetFramesProcessed() + ingest.GetFramesDropped() < submitted) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        buffer.Drain();
+    };
+
+    ingest.Start();
+    run(WARMUP_REVOLUTIONS);
+
+    uint64_t allocations = g_allocations.load();
+    uint64_t spokes = ingest.GetSpokesReceived();
+    run(REVOLUTIONS);
+    allocations = g_allocations.load() - allocations;
+    spokes = ingest.GetSpokesReceived() - spokes;
+
+    ingest.Stop();
+
+    printf("%llu spokes in %d revolutions, %llu frames dropped, %llu allocations\n",
+           (unsigned long long)spokes, REVOLUTIONS,
+           (unsigned long long)ingest.GetFramesDropped(), (unsigned long long)allocations);
+
+    if (spokes == 0 || ingest.GetDecodeErrors() != 0) {
+        printf("FAIL: spokes were not decoded\n");
+        return 1;
+    }
+    if (allocations != 0) {
+        printf("FAIL: the steady state allocated\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Times the RadarMessageReader in spokes per second
+ */
+
+#include "RadarMessageReader.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace mayara;
+
+static const size_t SPOKES = 8192;
+static const size_t SPOKES_PER_FRAME = 32;
+static const int REVOLUTIONS = 50;
+
+// mayara-server native: 8192 spokes per revolution is ~100k spokes/s
+// per radar
+static const double REQUIRED_SPOKES_PER_SECOND = 100000.0;
+
+static void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// RadarMessage frames covering one revolution
+static std::vector<std::vector<uint8_t>> MakeFrames(size_t spoke_len) {
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t first = 0; first < SPOKES; first += SPOKES_PER_FRAME) {
+        std::vector<uint8_t> message;
+        PutVarint(message, 1 << 3);               // radar
+        PutVarint(message, 1);
+        for (size_t angle = first; angle < first + SPOKES_PER_FRAME; angle++) {
+            std::vector<uint8_t> spoke;
+            PutVarint(spoke, 1 << 3);             // angle
+            PutVarint(spoke, angle);
+            PutVarint(spoke, 2 << 3);             // bearing
+            PutVarint(spoke, (angle + 1000) % SPOKES);
+            PutVarint(spoke, 3 << 3);             // range
+            PutVarint(spoke, 1852);
+            PutVarint(spoke, 4 << 3);             // time
+            PutVarint(spoke, 1700000000000ull + angle);
+            PutVarint(spoke, (5 << 3) | 2);       // data
+            PutVarint(spoke, spoke_len);
+            for (size_t i = 0; i < spoke_len; i++) {
+                spoke.push_back((uint8_t)(angle ^ i));
+            }
+            PutVarint(spoke, 6 << 3);             // lat
+            PutVarint(spoke, 500000000000000000ull);
+            PutVarint(spoke, 7 << 3);             // lon
+            PutVarint(spoke, (uint64_t)-40000000000000000ll);
+            PutVarint(message, (2 << 3) | 2);     // spokes
+            PutVarint(message, spoke.size());
+            message.insert(message.end(), spoke.begin(), spoke.end());
+        }
+        frames.push_back(message);
+    }
+    return frames;
+}
+
+static bool Run(size_t spoke_len) {
+    std::vector<std::vector<uint8_t>> frames = MakeFrames(spoke_len);
+
+    // Touch every spoke the way a consumer would, so the loop can't be
+    // optimised away
+    uint64_t spokes = 0, checksum = 0;
+    bool error = false;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REVOLUTIONS; r++) {
+        for (const std::vector<uint8_t>& frame : frames) {
+            RadarMessageReader reader(frame.data(), frame.size());
+            SpokeData spoke;
+            while (reader.Next(spoke)) {
+                spokes++;
+                checksum += spoke.angle + spoke.length + spoke.data[spoke.length - 1];
+            }
+            error |= reader.HasError();
+        }
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    double rate = spokes / seconds;
+    printf("%4zu byte spokes: %.2f M spokes/s, %.0fx the rate of one radar (checksum %llu)\n",
+           spoke_len, rate / 1e6, rate / REQUIRED_SPOKES_PER_SECOND,
+           (unsigned long long)checksum);
+
+    if (error || spokes != SPOKES * REVOLUTIONS) {
+        printf("FAIL: decoded %llu spokes of %zu\n", (unsigned long long)spokes,
+               SPOKES * REVOLUTIONS);
+        return false;
+    }
+    if (rate < REQUIRED_SPOKES_PER_SECOND) {
+        printf("FAIL: under %.0f spokes/s\n", REQUIRED_SPOKES_PER_SECOND);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    printf("%zu spokes, %zu per frame\n", SPOKES, SPOKES_PER_FRAME);
+
+    bool ok = true;
+    ok &= Run(512);
+    ok &= Run(1024);
+    ok &= Run(2048);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,360 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Runs a corpus of well-formed and malformed frames through the RadarMessageReader
+ */
+
+#include "RadarMessageReader.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mayara;
+
+// Mutated frames per corpus entry, on top of every truncation and
+// every single-byte overwrite
+static const int MUTATIONS = 20000;
+
+typedef std::vector<uint8_t> Bytes;
+
+static void PutVarint(Bytes& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static void PutTag(Bytes& out, uint32_t field, uint32_t wire_type) {
+    PutVarint(out, (uint64_t)field << 3 | wire_type);
+}
+
+static void PutBytes(Bytes& out, uint32_t field, const Bytes& bytes) {
+    PutTag(out, field, 2);
+    PutVarint(out, bytes.size());
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// A varint longer than the 10 bytes a uint64 needs
+static void PutOverlongVarint(Bytes& out) {
+    for (int i = 0; i < 10; i++) out.push_back(0x80);
+    out.push_back(0x00);
+}
+
+static Bytes MakeSpoke(uint32_t angle, size_t length) {
+    Bytes spoke;
+    PutTag(spoke, 1, 0);        // angle
+    PutVarint(spoke, angle);
+    PutTag(spoke, 2, 0);        // bearing
+    PutVarint(spoke, angle + 100);
+    PutTag(spoke, 3, 0);        // range
+    PutVarint(spoke, 1852);
+    PutTag(spoke, 4, 0);        // time
+    PutVarint(spoke, 1700000000000ull);
+    Bytes data(length);
+    for (size_t i = 0; i < length; i++) data[i] = (uint8_t)(angle + i);
+    PutBytes(spoke, 5, data);   // data
+    PutTag(spoke, 6, 0);        // lat
+    PutVarint(spoke, 500000000000000000ull);
+    PutTag(spoke, 7, 0);        // lon
+    PutVarint(spoke, (uint64_t)-40000000000000000ll);
+    return spoke;
+}
+
+static Bytes MakeMessage(uint32_t radar, uint32_t first, size_t count, size_t length) {
+    Bytes message;
+    PutTag(message, 1, 0);      // radar
+    PutVarint(message, radar);
+    for (size_t i = 0; i < count; i++) {
+        PutBytes(message, 2, MakeSpoke(first + (uint32_t)i, length));
+    }
+    return message;
+}
+
+struct Entry {
+    std::string name;
+    Bytes frame;
+    size_t spokes;      // Spokes Next() hands out before it stops
+    bool error;
+};
+
+static std::vector<Entry> MakeCorpus() {
+    std::vector<Entry> corpus;
+    Bytes frame, spoke;
+
+    corpus.push_back({ "empty", Bytes(), 0, false });
+    corpus.push_back({ "radar only", MakeMessage(3, 0, 0, 0), 0, false });
+    corpus.push_back({ "one spoke", MakeMessage(3, 10, 1, 64), 1, false });
+    corpus.push_back({ "32 spokes", MakeMessage(3, 100, 32, 1024), 32, false });
+    corpus.push_back({ "empty data", MakeMessage(3, 0, 1, 0), 1, false });
+
+    frame.clear();
+    PutBytes(frame, 2, Bytes());
+    corpus.push_back({ "empty spoke", frame, 1, false });
+
+    // Fields the reader doesn't know are skipped, whatever their wire type
+    frame.clear();
+    spoke = MakeSpoke(5, 16);
+    PutTag(spoke, 20, 5);
+    spoke.insert(spoke.end(), 4, 0xFF);
+    PutTag(spoke, 21, 1);
+    spoke.insert(spoke.end(), 8, 0xFF);
+    PutTag(frame, 9, 0);
+    PutVarint(frame, ~0ull);
+    PutBytes(frame, 10, Bytes(40, 0x80));
+    PutBytes(frame, 2, spoke);
+    PutTag(frame, 11, 5);
+    frame.insert(frame.end(), 4, 0x80);
+    corpus.push_back({ "unknown fields", frame, 1, false });
+
+    // A known field with the wrong wire type is skipped as unknown
+    frame.clear();
+    PutTag(frame, 1, 2);        // radar as bytes
+    PutVarint(frame, 2);
+    frame.push_back(0x01);
+    frame.push_back(0x02);
+    PutTag(frame, 2, 0);        // spokes as a varint
+    PutVarint(frame, 12345);
+    corpus.push_back({ "wrong wire type radar, spokes", frame, 0, false });
+
+    frame.clear();
+    spoke.clear();
+    PutTag(spoke, 1, 5);        // angle as fixed32
+    spoke.insert(spoke.end(), 4, 0x7F);
+    PutTag(spoke, 5, 0);        // data as a varint
+    PutVarint(spoke, 1024);
+    PutBytes(frame, 2, spoke);
+    corpus.push_back({ "wrong wire type angle, data", frame, 1, false });
+
+    // Groups and the reserved wire types are malformed
+    for (uint32_t wire_type : { 3u, 4u, 6u, 7u }) {
+        frame = MakeMessage(3, 0, 1, 8);
+        PutTag(frame, 2, wire_type);
+        frame.push_back(0);
+        corpus.push_back({ "wire type " + std::to_string(wire_type), frame, 1, true });
+
+        frame.clear();
+        spoke = MakeSpoke(0, 8);
+        PutTag(spoke, 5, wire_type);
+        PutBytes(frame, 2, spoke);
+        corpus.push_back({ "spoke wire type " + std::to_string(wire_type), frame, 0, true });
+    }
+
+    // Ten bytes is the longest varint, whatever its value
+    frame.clear();
+    PutTag(frame, 1, 0);
+    PutVarint(frame, ~0ull);
+    corpus.push_back({ "ten byte varint", frame, 0, false });
+
+    frame.clear();
+    PutOverlongVarint(frame);
+    corpus.push_back({ "overlong tag", frame, 0, true });
+
+    frame.clear();
+    PutTag(frame, 1, 0);
+    PutOverlongVarint(frame);
+    corpus.push_back({ "overlong radar", frame, 0, true });
+
+    frame = MakeMessage(3, 0, 1, 8);
+    PutTag(frame, 2, 2);
+    PutOverlongVarint(frame);
+    corpus.push_back({ "overlong spoke length", frame, 1, true });
+
+    frame.clear();
+    spoke.clear();
+    PutTag(spoke, 3, 0);
+    PutOverlongVarint(spoke);
+    PutBytes(frame, 2, spoke);
+    corpus.push_back({ "overlong range", frame, 0, true });
+
+    frame.clear();
+    spoke.clear();
+    PutTag(spoke, 5, 2);
+    PutOverlongVarint(spoke);
+    PutBytes(frame, 2, spoke);
+    corpus.push_back({ "overlong data length", frame, 0, true });
+
+    // Truncated anywhere: in a tag, a value, a length or the payload
+    frame = MakeMessage(3, 0, 1, 8);
+    frame.push_back(0x80);
+    corpus.push_back({ "truncated tag", frame, 1, true });
+
+    frame.clear();
+    PutTag(frame, 1, 0);
+    frame.push_back(0xFF);
+    corpus.push_back({ "truncated radar", frame, 0, true });
+
+    frame = MakeMessage(3, 0, 2, 64);
+    frame.resize(frame.size() - 10);
+    corpus.push_back({ "truncated spoke", frame, 1, true });
+
+    frame.clear();
+    PutTag(frame, 9, 1);
+    frame.insert(frame.end(), 7, 0);
+    corpus.push_back({ "truncated fixed64", frame, 0, true });
+
+    frame.clear();
+    PutTag(frame, 9, 5);
+    frame.insert(frame.end(), 3, 0);
+    corpus.push_back({ "truncated fixed32", frame, 0, true });
+
+    // Lengths past the end of the frame, or of the enclosing spoke
+    frame.clear();
+    spoke = MakeSpoke(0, 32);
+    PutTag(frame, 2, 2);
+    PutVarint(frame, spoke.size() + 1);
+    frame.insert(frame.end(), spoke.begin(), spoke.end());
+    corpus.push_back({ "oversized spoke length", frame, 0, true });
+
+    frame.clear();
+    spoke.clear();
+    PutTag(spoke, 5, 2);
+    PutVarint(spoke, 16);
+    spoke.insert(spoke.end(), 8, 0xAA);
+    PutBytes(frame, 2, spoke);
+    frame.insert(frame.end(), 16, 0xAA);
+    corpus.push_back({ "data past the spoke", frame, 0, true });
+
+    frame.clear();
+    PutTag(frame, 2, 2);
+    PutVarint(frame, ~0ull);
+    frame.insert(frame.end(), 16, 0);
+    corpus.push_back({ "huge spoke length", frame, 0, true });
+
+    frame.clear();
+    PutTag(frame, 10, 2);
+    PutVarint(frame, 1ull << 63);
+    corpus.push_back({ "huge unknown length", frame, 0, true });
+
+    return corpus;
+}
+
+// Decodes a frame held in a buffer of exactly its size, so a sanitizer
+// build catches any read past its end. Returns false if a spoke points
+// outside the frame or the reader doesn't make progress.
+static bool Decode(const Bytes& input, size_t& spokes, bool& error, uint32_t& radar) {
+    std::vector<uint8_t> frame(input);
+    const uint8_t* begin = frame.data();
+    const uint8_t* end = begin + frame.size();
+
+    RadarMessageReader reader(begin, frame.size());
+    SpokeData spoke;
+    spokes = 0;
+    while (reader.Next(spoke)) {
+        // Every spoke takes at least a tag and a length
+        if (++spokes > frame.size() / 2) return false;
+        if (spoke.length == 0) continue;
+        if (spoke.data < begin || spoke.data > end ||
+            spoke.length > (size_t)(end - spoke.data)) {
+            return false;
+        }
+    }
+    error = reader.HasError();
+    radar = reader.GetRadar();
+    return true;
+}
+
+static bool RunCorpus(const std::vector<Entry>& corpus) {
+    bool ok = true;
+    for (const Entry& entry : corpus) {
+        size_t spokes;
+        bool error;
+        uint32_t radar;
+        if (!Decode(entry.frame, spokes, error, radar) ||
+            spokes != entry.spokes || error != entry.error) {
+            printf("FAIL: %s: %zu spokes%s, expected %zu%s\n", entry.name.c_str(), spokes,
+                   error ? " then an error" : "", entry.spokes,
+                   entry.error ? " then an error" : "");
+            ok = false;
+        }
+    }
+    printf("corpus: %zu frames\n", corpus.size());
+    return ok;
+}
+
+// Every field of a well-formed spoke comes back as it was sent
+static bool RunFields() {
+    Bytes frame = MakeMessage(7, 4000, 2, 300);
+    RadarMessageReader reader(frame.data(), frame.size());
+    SpokeData spoke;
+    for (uint32_t angle = 4000; angle < 4002; angle++) {
+        if (!reader.Next(spoke) || reader.GetRadar() != 7 || spoke.angle != angle ||
+            !spoke.hasBearing || spoke.bearing != angle + 100 || spoke.rangeMeters != 1852 ||
+            spoke.timestamp != 1700000000000ull || spoke.lat != 500000000000000000ll ||
+            spoke.lon != -40000000000000000ll || spoke.length != 300) {
+            printf("FAIL: spoke %u decoded wrong\n", angle);
+            return false;
+        }
+        for (size_t i = 0; i < spoke.length; i++) {
+            if (spoke.data[i] != (uint8_t)(angle + i)) {
+                printf("FAIL: spoke %u data differs at %zu\n", angle, i);
+                return false;
+            }
+        }
+    }
+    if (reader.Next(spoke) || reader.HasError()) {
+        printf("FAIL: more than two spokes\n");
+        return false;
+    }
+    return true;
+}
+
+static bool Mutate(const Entry& entry, const Bytes& frame, const char* how, size_t at) {
+    size_t spokes;
+    bool error;
+    uint32_t radar;
+    if (Decode(frame, spokes, error, radar)) return true;
+    printf("FAIL: %s, %s at %zu: spoke outside the frame\n", entry.name.c_str(), how, at);
+    return false;
+}
+
+// Truncations, overwrites and random mutations of every corpus entry
+static bool RunFuzz(const std::vector<Entry>& corpus) {
+    std::mt19937 rng(1);
+    size_t frames = 0;
+    bool ok = true;
+    for (const Entry& entry : corpus) {
+        const Bytes& original = entry.frame;
+        for (size_t len = 0; len < original.size(); len++) {
+            ok &= Mutate(entry, Bytes(original.begin(), original.begin() + len),
+                         "truncated", len);
+            frames++;
+        }
+        for (size_t i = 0; i < original.size(); i++) {
+            for (uint8_t value : { 0x00, 0x7F, 0x80, 0xFF }) {
+                Bytes frame(original);
+                frame[i] = value;
+                ok &= Mutate(entry, frame, "overwritten", i);
+                frames++;
+            }
+        }
+        for (int m = 0; m < MUTATIONS && !original.empty(); m++) {
+            Bytes frame(original);
+            int edits = 1 + rng() % 4;
+            for (int e = 0; e < edits && !frame.empty(); e++) {
+                size_t at = rng() % frame.size();
+                switch (rng() % 4) {
+                    case 0: frame[at] ^= (uint8_t)(1 << rng() % 8); break;
+                    case 1: frame[at] = (uint8_t)rng(); break;
+                    case 2: frame.insert(frame.begin() + at, (uint8_t)rng()); break;
+                    default: frame.erase(frame.begin() + at); break;
+                }
+            }
+            ok &= Mutate(entry, frame, "mutation", (size_t)m);
+            frames++;
+        }
+    }
+    printf("fuzz: %zu frames\n", frames);
+    return ok;
+}
+
+int main() {
+    std::vector<Entry> corpus = MakeCorpus();
+    bool ok = RunFields();
+    ok &= RunCorpus(corpus);
+    ok &= RunFuzz(corpus);
+    return ok ? 0 : 1;
+}
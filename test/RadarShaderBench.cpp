@@ -0,0 +1,154 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Renders the PPI offscreen through the analytic and the lookup texture
+ * shaders and times them in fragments per second
+ */
+
+#include "RadarPPIRenderer.h"
+#include "SpokeBuffer.h"
+#include <EGL/egl.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace mayara;
+
+static const int SIZE = 1024;
+static const size_t SPOKES = 2048;
+static const size_t SPOKE_LEN = 1024;
+static const int FRAMES = 50;
+
+// Both paths sample the same texels, bar pixels right on a spoke or
+// range cell boundary
+static const double MAX_DIFFERING_PIXELS = 0.02;
+
+// ctest reports the bench as skipped when there is no GL to run it on
+static const int SKIP = 77;
+
+// A desktop GL context on a pbuffer, without a window system
+static bool MakeContext() {
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) return false;
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint count = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &count) || count == 0) {
+        return false;
+    }
+
+    const EGLint surface_attributes[] = { EGL_WIDTH, SIZE, EGL_HEIGHT, SIZE, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surface_attributes);
+    if (surface == EGL_NO_SURFACE || !eglBindAPI(EGL_OPENGL_API)) return false;
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    return context != EGL_NO_CONTEXT && eglMakeCurrent(display, surface, surface, context);
+}
+
+// Echoes in blocks of 16 spokes by 16 range cells, each a few pixels
+// across, so the paths can be compared away from the block edges
+static void FillBuffer(SpokeBuffer& buffer) {
+    std::vector<uint8_t> data(SPOKE_LEN);
+    for (uint32_t angle = 0; angle < SPOKES; angle++) {
+        for (size_t i = 0; i < SPOKE_LEN; i++) {
+            data[i] = (uint8_t)(angle / 16 * 37 + i / 16 * 11);
+        }
+        buffer.WriteSpoke(angle, data.data(), SPOKE_LEN, 1852);
+    }
+}
+
+// One frame read back, for comparing the paths
+static void DrawFrame(RadarPPIRenderer& renderer, double heading, std::vector<uint8_t>& pixels) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderer.DrawPPI(nullptr, SIZE, SIZE, 1852.0, heading);
+    pixels.resize((size_t)SIZE * SIZE * 4);
+    glReadPixels(0, 0, SIZE, SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+// Fragments of the radar disk per second, rotating so every frame is new
+static double Time(RadarPPIRenderer& renderer) {
+    float cx, cy, radius;
+    renderer.GetDisplayGeometry(SIZE, SIZE, cx, cy, radius);
+
+    glFinish();
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        renderer.DrawPPI(nullptr, SIZE, SIZE, 1852.0, frame * 7.0);
+    }
+    glFinish();
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return FRAMES * M_PI * radius * radius / seconds;
+}
+
+int main() {
+    if (!MakeContext()) {
+        printf("SKIP: no EGL display with desktop GL\n");
+        return SKIP;
+    }
+    printf("%s, %s\n", (const char*)glGetString(GL_RENDERER),
+           (const char*)glGetString(GL_VERSION));
+    glViewport(0, 0, SIZE, SIZE);
+
+    SpokeBuffer buffer(SPOKES, SPOKE_LEN);
+    FillBuffer(buffer);
+
+    RadarPPIRenderer renderer;
+    renderer.Init(SPOKES, SPOKE_LEN);
+    renderer.SetShowRangeRings(false);
+    renderer.SetShowHeadingLine(false);
+    if (!renderer.HasShaders()) {
+        printf("SKIP: no shaders\n");
+        return SKIP;
+    }
+    renderer.UpdateTexture(&buffer);
+
+    renderer.SetUsePolarLookup(false);
+    double analytic = Time(renderer);
+    printf("analytic atan/length: %7.1f M fragments/s\n", analytic / 1e6);
+
+    renderer.SetUsePolarLookup(true);
+    if (!renderer.IsUsingPolarLookup()) {
+        printf("lookup texture: unsupported by this GL\n");
+        return 0;
+    }
+    double lookup = Time(renderer);
+    printf("lookup texture:       %7.1f M fragments/s, %.2fx\n", lookup / 1e6,
+           lookup / analytic);
+
+    bool ok = true;
+    std::vector<uint8_t> expected, actual;
+    for (double heading : { 0.0, 33.0 }) {
+        renderer.SetUsePolarLookup(false);
+        DrawFrame(renderer, heading, expected);
+        renderer.SetUsePolarLookup(true);
+        DrawFrame(renderer, heading, actual);
+
+        size_t differing = 0;
+        for (size_t i = 0; i < expected.size(); i += 4) {
+            for (size_t c = 0; c < 3; c++) {
+                if (abs(expected[i + c] - actual[i + c]) > 8) {
+                    differing++;
+                    break;
+                }
+            }
+        }
+        double share = (double)differing / (SIZE * SIZE);
+        printf("heading %2.0f: %.2f%% of the pixels differ\n", heading, share * 100.0);
+        if (share > MAX_DIFFERING_PIXELS) {
+            printf("FAIL: the lookup texture image differs from the analytic one\n");
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
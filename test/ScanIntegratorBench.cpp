@@ -0,0 +1,148 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Times the ScanIntegrator against its budget and checks its output
+ */
+
+#include "ScanIntegrator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace mayara;
+
+static const size_t SPOKES = 8192;
+static const size_t SPOKE_LEN = 1024;
+static const size_t SPOKES_PER_FRAME = 32;
+static const int REVOLUTIONS = 10;
+
+// 5% of one core at 24 RPM, i.e. 2.5 s per revolution
+static const double BUDGET_MS = 2500.0 * 0.05;
+
+// Some spokes are a little short so the scalar tails run too
+static size_t SpokeLength(size_t angle) {
+    return SPOKE_LEN - angle % 7;
+}
+
+// Reproducible noise, mostly below the M-of-N threshold
+static uint8_t Sample(uint32_t revolution, uint32_t angle, uint32_t i) {
+    uint32_t h = revolution * 0x9E3779B1u ^ angle * 0x85EBCA77u ^ i * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return (uint8_t)h;
+}
+
+static void MakeRevolution(uint32_t revolution, std::vector<uint8_t>& data,
+                           std::vector<SpokeData>& spokes) {
+    for (uint32_t angle = 0; angle < SPOKES; angle++) {
+        uint8_t* row = &data[angle * SPOKE_LEN];
+        for (uint32_t i = 0; i < SPOKE_LEN; i++) {
+            row[i] = Sample(revolution, angle, i);
+        }
+        SpokeData& spoke = spokes[angle];
+        spoke = SpokeData();
+        spoke.angle = angle;
+        spoke.rangeMeters = 1852;
+        spoke.data = row;
+        spoke.length = SpokeLength(angle);
+    }
+}
+
+// Scalar result for one sample of the last revolution, with rows
+// revolutions of history
+static uint8_t Reference(IntegrationMode mode, uint32_t last, size_t rows,
+                         size_t required, uint8_t threshold, uint32_t angle, uint32_t i) {
+    uint8_t now = Sample(last, angle, i);
+    uint32_t min = 255, sum = 0;
+    size_t hits = 0;
+    for (size_t r = 0; r < rows; r++) {
+        uint8_t v = Sample(last - (uint32_t)r, angle, i);
+        min = std::min<uint32_t>(min, v);
+        sum += v;
+        hits += v >= threshold;
+    }
+    switch (mode) {
+        case IntegrationMode::Min:
+            return (uint8_t)min;
+        case IntegrationMode::Mean:
+            return (uint8_t)std::min<uint32_t>((sum * ((65536 + rows - 1) / rows)) >> 16, 255);
+        case IntegrationMode::MofN:
+            return hits >= required ? now : 0;
+        default:
+            return now;
+    }
+}
+
+static bool Run(IntegrationMode mode, const char* name, size_t revolutions, size_t required) {
+    const uint8_t threshold = 200;
+    ScanIntegrator integrator(SPOKES, SPOKE_LEN, revolutions, mode);
+    integrator.SetRequired(required);
+    integrator.SetThreshold(threshold);
+
+    std::vector<uint8_t> data(SPOKES * SPOKE_LEN);
+    std::vector<SpokeData> spokes(SPOKES);
+    std::vector<SpokeData> out;
+    std::vector<uint8_t> last(SPOKES * SPOKE_LEN);
+    double total_ms = 0;
+
+    // The first N revolutions fill the history and aren't timed
+    uint32_t count = (uint32_t)(revolutions + REVOLUTIONS);
+    for (uint32_t r = 0; r < count; r++) {
+        MakeRevolution(r, data, spokes);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < SPOKES; first += SPOKES_PER_FRAME) {
+            integrator.Process(&spokes[first], SPOKES_PER_FRAME, out);
+            if (r == count - 1) {
+                for (const SpokeData& spoke : out) {
+                    std::copy(spoke.data, spoke.data + spoke.length,
+                              &last[spoke.angle * SPOKE_LEN]);
+                }
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        if (r >= revolutions) {
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+
+    size_t mismatches = 0;
+    for (uint32_t angle = 0; angle < SPOKES; angle++) {
+        for (uint32_t i = 0; i < SpokeLength(angle); i++) {
+            uint8_t expected = Reference(mode, count - 1, revolutions, required,
+                                         threshold, angle, i);
+            mismatches += last[angle * SPOKE_LEN + i] != expected;
+        }
+    }
+
+    double per_revolution = total_ms / REVOLUTIONS;
+    printf("%-5s N=%zu M=%zu: %6.2f ms per revolution, %4.2f%% of a core at 24 RPM, "
+           "%zu mismatches\n", name, revolutions, required, per_revolution,
+           per_revolution / 2500.0 * 100.0, mismatches);
+
+    if (mismatches != 0) {
+        printf("FAIL: output differs from the scalar reference\n");
+        return false;
+    }
+    if (per_revolution > BUDGET_MS) {
+        printf("FAIL: over the budget of %.0f ms per revolution\n", BUDGET_MS);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    printf("%zu x %zu spokes, %zu per frame\n", SPOKES, SPOKE_LEN, SPOKES_PER_FRAME);
+
+    bool ok = true;
+    ok &= Run(IntegrationMode::Min, "Min", 3, 2);
+    ok &= Run(IntegrationMode::Min, "Min", 8, 2);
+    ok &= Run(IntegrationMode::Mean, "Mean", 3, 2);
+    ok &= Run(IntegrationMode::Mean, "Mean", 8, 2);
+    ok &= Run(IntegrationMode::MofN, "MofN", 3, 2);
+    ok &= Run(IntegrationMode::MofN, "MofN", 8, 5);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+ * MaYaRa Server Plugin for OpenCPN
+ * Copyright (c) 2025 MarineYachtRadar
+ * License: MIT
+ *
+ * Replays synthetic tracks through the TargetTracker
+ */
+
+#include "TargetTracker.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mayara;
+
+// 24 RPM, and the share of a sweep one update may take
+static const double SWEEP_SECONDS = 2.5;
+static const double BUDGET_MS = SWEEP_SECONDS * 1000.0 * 0.05;
+
+static const int SWEEPS = 40;
+static const double NOISE_METERS = 8.0;
+
+// A target counts as tracked when a reported track is this close
+static const double MAX_POSITION_ERROR = 30.0;
+static const double MAX_SPEED_ERROR = 2.0;         // knots
+static const double MIN_TRACKED = 0.95;
+
+static const double METERS_PER_DEGREE = 111320.0;
+
+struct Truth {
+    double x, y;        // Meters east and north
+    double vx, vy;      // m/s
+};
+
+// Own ship, moving north with its bow turned away from its course so
+// relative and true bearings differ
+struct Ship {
+    double y = 0.0;
+    double heading = 30.0;
+    double sog = 10.0;  // knots
+
+    GeoPosition Position() const { return GeoPosition(50.0 + y / METERS_PER_DEGREE, 0.0); }
+    void Advance() { y += sog * OwnShip::KNOTS_TO_MPS * SWEEP_SECONDS; }
+};
+
+static BlobList MakeSweep(int sweep) {
+    BlobList blobs;
+    blobs.revolution = sweep;
+    blobs.time = 1700000000000ull + (uint64_t)(sweep * SWEEP_SECONDS * 1000.0);
+    blobs.spokes = 8192;
+    blobs.spokeLen = 1024;
+    blobs.gridRange = 24000;
+    return blobs;
+}
+
+// A blob at a position relative to own ship, as the detector reports it
+static void AddBlob(BlobList& blobs, double east, double north, double heading) {
+    double distance = sqrt(east * east + north * north);
+    if (distance >= blobs.gridRange) return;
+    double bearing = fmod(RadToDeg(atan2(east, north)) - heading + 720.0, 360.0);
+    blobs.angle.push_back((float)(bearing * blobs.spokes / 360.0));
+    blobs.range.push_back((float)(distance * blobs.spokeLen / blobs.gridRange));
+    blobs.angleFirst.push_back(0);
+    blobs.angleCount.push_back(1);
+    blobs.rangeFirst.push_back(0);
+    blobs.rangeCount.push_back(1);
+    blobs.peak.push_back(200);
+    blobs.cells.push_back(4);
+}
+
+// One stationary target acquired by clicking its echo: its CPA is its
+// offset from own ship's track
+static bool RunAcquisition() {
+    Ship ship;
+    TargetTracker tracker;
+    tracker.SetOwnShip(ship.Position(), ship.heading, 0.0, ship.sog);
+
+    const double east = 200.0, north = 3000.0;
+    for (int sweep = 0; sweep < 20; sweep++) {
+        BlobList blobs = MakeSweep(sweep);
+        AddBlob(blobs, east, north - ship.y, ship.heading);
+        if (sweep == 0) {
+            double bearing = RadToDeg(atan2(east, north)) - ship.heading;
+            tracker.Acquire(fmod(bearing + 360.0, 360.0), sqrt(east * east + north * north));
+        }
+        tracker.Update(blobs);
+        if (sweep < 19) {
+            ship.Advance();
+            tracker.SetOwnShip(ship.Position(), ship.heading, 0.0, ship.sog);
+        }
+    }
+
+    auto targets = tracker.GetTargets();
+    double tcpa = (north - ship.y) / (ship.sog * OwnShip::KNOTS_TO_MPS) / 60.0;
+    if (targets->size() != 1) {
+        printf("acquisition: %zu targets\n", targets->size());
+        printf("FAIL: the acquired target is not tracked\n");
+        return false;
+    }
+    const ArpaTarget& target = targets->front();
+    printf("acquisition: cpa %.0f m (expect %.0f), tcpa %.2f min (expect %.2f), "
+           "speed %.2f kn\n", target.cpa, east, target.tcpa, tcpa, target.speed);
+    if (fabs(target.cpa - east) > MAX_POSITION_ERROR || fabs(target.tcpa - tcpa) > 0.1 ||
+        target.speed > MAX_SPEED_ERROR) {
+        printf("FAIL: wrong CPA or motion of the acquired target\n");
+        return false;
+    }
+    return true;
+}
+
+// Every blob tracked, targets moving up to 20 knots, with clutter
+static bool RunReplay(int count) {
+    std::mt19937 rng(count);
+    std::uniform_real_distribution<double> position(-15000.0, 15000.0);
+    std::uniform_real_distribution<double> velocity(-7.0, 7.0);
+    std::normal_distribution<double> noise(0.0, NOISE_METERS);
+
+    std::vector<Truth> truth(count);
+    for (Truth& t : truth) {
+        t = { position(rng), position(rng), velocity(rng), velocity(rng) };
+    }
+
+    Ship ship;
+    TargetTracker tracker;
+    tracker.SetAutoAcquire(true);
+    tracker.SetOwnShip(ship.Position(), ship.heading, 0.0, ship.sog);
+
+    double total_ms = 0.0, max_ms = 0.0;
+    for (int sweep = 0; sweep < SWEEPS; sweep++) {
+        BlobList blobs = MakeSweep(sweep);
+        for (const Truth& t : truth) {
+            AddBlob(blobs, t.x + noise(rng), t.y - ship.y + noise(rng), ship.heading);
+        }
+        for (int c = 0; c < count / 10; c++) {
+            AddBlob(blobs, position(rng), position(rng), ship.heading);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        tracker.Update(blobs);
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        total_ms += ms;
+        max_ms = std::max(max_ms, ms);
+
+        if (sweep < SWEEPS - 1) {
+            for (Truth& t : truth) {
+                t.x += t.vx * SWEEP_SECONDS;
+                t.y += t.vy * SWEEP_SECONDS;
+            }
+            ship.Advance();
+            tracker.SetOwnShip(ship.Position(), ship.heading, 0.0, ship.sog);
+        }
+    }
+
+    // Reported positions are relative to own ship
+    auto targets = tracker.GetTargets();
+    int tracked = 0, visible = 0;
+    for (const Truth& t : truth) {
+        double east = t.x, north = t.y - ship.y;
+        if (sqrt(east * east + north * north) >= 24000.0) continue;
+        visible++;
+        double speed = sqrt(t.vx * t.vx + t.vy * t.vy) / OwnShip::KNOTS_TO_MPS;
+        for (const ArpaTarget& target : *targets) {
+            double x = target.distance * sin(DegToRad(target.bearing));
+            double y = target.distance * cos(DegToRad(target.bearing));
+            if (hypot(x - east, y - north) < MAX_POSITION_ERROR &&
+                fabs(target.speed - speed) < MAX_SPEED_ERROR) {
+                tracked++;
+                break;
+            }
+        }
+    }
+
+    double share = visible ? (double)tracked / visible : 0.0;
+    printf("%4d targets: %zu tracks, %zu reported, %d of %d tracked (%.1f%%), "
+           "%.2f ms per sweep, %.2f ms worst\n", count, tracker.GetTrackCount(),
+           targets->size(), tracked, visible, share * 100.0, total_ms / SWEEPS, max_ms);
+
+    if (share < MIN_TRACKED) {
+        printf("FAIL: fewer than %.0f%% of the targets tracked\n", MIN_TRACKED * 100.0);
+        return false;
+    }
+    if (total_ms / SWEEPS > BUDGET_MS) {
+        printf("FAIL: over the budget of %.0f ms per sweep\n", BUDGET_MS);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    bool ok = RunAcquisition();
+    ok &= RunReplay(500);
+    ok &= RunReplay(1000);
+    ok &= RunReplay(2000);
+    return ok ? 0 : 1;
+}